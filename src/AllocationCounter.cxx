@@ -0,0 +1,72 @@
+
+#include <stdio.h>
+
+#include <atomic>
+
+#include "AllocationCounter.h"
+
+// Constant-initialized, so they are usable by allocations made before any
+// static constructor has run.
+static std::atomic<Long64_t> gAllocations{0};
+static std::atomic<Long64_t> gBytes{0};
+static std::atomic<Long64_t> gFrees{0};
+static std::atomic<Long64_t> gLiveBytes{0};
+static std::atomic<Long64_t> gPeakLiveBytes{0};
+static std::atomic<bool> gActive{false};
+
+void RecordAllocation(size_t requested, size_t usable) {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    gBytes.fetch_add(requested, std::memory_order_relaxed);
+    Long64_t live = gLiveBytes.fetch_add(usable, std::memory_order_relaxed) + usable;
+    Long64_t peak = gPeakLiveBytes.load(std::memory_order_relaxed);
+    while (live > peak && !gPeakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+}
+
+void RecordFree(size_t usable) {
+    gFrees.fetch_add(1, std::memory_order_relaxed);
+    gLiveBytes.fetch_sub(usable, std::memory_order_relaxed);
+}
+
+void SetAllocationCountingActive() {
+    gActive = true;
+}
+
+bool AllocationCountingActive() {
+    return gActive;
+}
+
+AllocationCounts GetAllocationCounts() {
+    AllocationCounts counts;
+    counts.allocations = gAllocations.load(std::memory_order_relaxed);
+    counts.bytes = gBytes.load(std::memory_order_relaxed);
+    counts.frees = gFrees.load(std::memory_order_relaxed);
+    return counts;
+}
+
+Long64_t GetPeakLiveBytes() {
+    return gPeakLiveBytes.load(std::memory_order_relaxed);
+}
+
+void ResetPeakLiveBytes() {
+    gPeakLiveBytes.store(gLiveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+Long64_t GetPeakRSS() {
+    FILE *fp = fopen("/proc/self/status", "r");
+    if (!fp) {return -1;}
+    char line[256];
+    Long64_t peak_kb = -1;
+    while (fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "VmHWM: %lld kB", &peak_kb) == 1) {break;}
+    }
+    fclose(fp);
+    return peak_kb < 0 ? -1 : peak_kb * 1024;
+}
+
+bool ResetPeakRSS() {
+    // Writing 5 resets VmHWM to the current RSS (Linux 4.0 and later).
+    FILE *fp = fopen("/proc/self/clear_refs", "w");
+    if (!fp) {return false;}
+    bool ok = fputs("5", fp) >= 0;
+    return (fclose(fp) == 0) && ok;
+}
@@ -0,0 +1,42 @@
+#ifndef BULKAPI_ALLOCATION_COUNTER_H
+#define BULKAPI_ALLOCATION_COUNTER_H
+
+#include <stddef.h>
+
+#include "Rtypes.h"
+
+/**
+ * Process-wide heap accounting.
+ *
+ * The counters only move in executables that also link AllocationHooks.cxx,
+ * which interposes malloc and friends (and so operator new, and every
+ * allocation ROOT makes).  Without it AllocationCountingActive() is false
+ * and every count stays zero.
+ */
+struct AllocationCounts {
+    Long64_t allocations{0};   // malloc/calloc/realloc/memalign calls that returned memory.
+    Long64_t bytes{0};         // Bytes requested by those calls.
+    Long64_t frees{0};
+};
+
+bool AllocationCountingActive();
+AllocationCounts GetAllocationCounts();
+
+/// Highest number of live heap bytes since the last reset.
+Long64_t GetPeakLiveBytes();
+void ResetPeakLiveBytes();
+
+/**
+ * Peak resident set size (VmHWM) in bytes, or -1 if /proc is unavailable.
+ * ResetPeakRSS() returns false where the kernel does not support resetting
+ * it, in which case the peak covers the whole process lifetime.
+ */
+Long64_t GetPeakRSS();
+bool ResetPeakRSS();
+
+// Called by the interposed allocator.
+void RecordAllocation(size_t requested, size_t usable);
+void RecordFree(size_t usable);
+void SetAllocationCountingActive();
+
+#endif  // BULKAPI_ALLOCATION_COUNTER_H
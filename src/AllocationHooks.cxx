@@ -0,0 +1,113 @@
+
+#include <errno.h>
+#include <malloc.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "AllocationCounter.h"
+
+/**
+ * Interposes the C allocator so AllocationCounter sees every heap
+ * allocation in the process, including operator new and those made inside
+ * ROOT's shared libraries.  Link this file into an executable (not a
+ * library) to turn the counters on.
+ *
+ * Every allocating entry point glibc exports is covered, since a block
+ * that bypassed RecordAllocation would still be subtracted by free() and
+ * drag the live-byte count (and so the peak) down.
+ *
+ * Requires glibc, whose __libc_* entry points do the real work.  The
+ * attributes keep -fwhole-program from internalizing the definitions.
+ */
+
+extern "C" {
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *ptr);
+
+#define BULKAPI_INTERPOSE __attribute__((externally_visible, used))
+
+BULKAPI_INTERPOSE void *malloc(size_t size) {
+    void *ptr = __libc_malloc(size);
+    if (ptr) {RecordAllocation(size, malloc_usable_size(ptr));}
+    return ptr;
+}
+
+BULKAPI_INTERPOSE void *calloc(size_t count, size_t size) {
+    void *ptr = __libc_calloc(count, size);
+    if (ptr) {RecordAllocation(count * size, malloc_usable_size(ptr));}
+    return ptr;
+}
+
+BULKAPI_INTERPOSE void *realloc(void *old, size_t size) {
+    size_t old_usable = old ? malloc_usable_size(old) : 0;
+    void *ptr = __libc_realloc(old, size);
+    // A failed realloc leaves the old block alone; realloc(p, 0) frees it.
+    if (!ptr && size) {return ptr;}
+    if (old) {RecordFree(old_usable);}
+    if (ptr) {RecordAllocation(size, malloc_usable_size(ptr));}
+    return ptr;
+}
+
+BULKAPI_INTERPOSE void *reallocarray(void *old, size_t count, size_t size) {
+    if (size && count > SIZE_MAX / size) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    return realloc(old, count * size);
+}
+
+BULKAPI_INTERPOSE void *memalign(size_t alignment, size_t size) {
+    void *ptr = __libc_memalign(alignment, size);
+    if (ptr) {RecordAllocation(size, malloc_usable_size(ptr));}
+    return ptr;
+}
+
+BULKAPI_INTERPOSE void *aligned_alloc(size_t alignment, size_t size) {
+    return memalign(alignment, size);
+}
+
+BULKAPI_INTERPOSE void *valloc(size_t size) {
+    return memalign(sysconf(_SC_PAGESIZE), size);
+}
+
+BULKAPI_INTERPOSE void *pvalloc(size_t size) {
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t rounded = (size + page - 1) & ~(page - 1);
+    if (rounded < size) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    // pvalloc(0) still returns a whole page.
+    return memalign(page, rounded ? rounded : page);
+}
+
+BULKAPI_INTERPOSE int posix_memalign(void **out, size_t alignment, size_t size) {
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1))) {return EINVAL;}
+    void *ptr = memalign(alignment, size);
+    if (!ptr) {return ENOMEM;}
+    *out = ptr;
+    return 0;
+}
+
+BULKAPI_INTERPOSE void free(void *ptr) {
+    if (!ptr) {return;}
+    RecordFree(malloc_usable_size(ptr));
+    __libc_free(ptr);
+}
+
+#undef BULKAPI_INTERPOSE
+
+}  // extern "C"
+
+namespace {
+
+struct ActivateCounting {
+    ActivateCounting() {SetAllocationCountingActive();}
+} gActivateCounting;
+
+}  // namespace
@@ -0,0 +1,234 @@
+#include <math.h>
+#include <string.h>
+
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BULKAPI_X86_KERNELS 1
+#endif
+
+#include "AnalysisKernels.h"
+
+static const int kHistogramCopies = 4;
+
+bool ParseAnalysisKernel(const char *name, AnalysisKernel &kernel) {
+    for (auto candidate : {AnalysisKernel::kSum, AnalysisKernel::kMinMax, AnalysisKernel::kMoments,
+                           AnalysisKernel::kCutCount, AnalysisKernel::kHistogram, AnalysisKernel::kAll}) {
+        if (!strcmp(name, GetAnalysisKernelName(candidate))) {
+            kernel = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *GetAnalysisKernelName(AnalysisKernel kernel) {
+    switch (kernel) {
+    case AnalysisKernel::kSum:
+        return "sum";
+    case AnalysisKernel::kMinMax:
+        return "minmax";
+    case AnalysisKernel::kMoments:
+        return "moments";
+    case AnalysisKernel::kCutCount:
+        return "cut";
+    case AnalysisKernel::kHistogram:
+        return "histogram";
+    case AnalysisKernel::kAll:
+        return "all";
+    }
+    return "unknown";
+}
+
+bool AnalysisSimdSupported() {
+#ifdef BULKAPI_X86_KERNELS
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+FloatAnalysis::FloatAnalysis(AnalysisKernel kernel, float cut, float low, float high, int bins)
+    : fDoSum(kernel == AnalysisKernel::kSum || kernel == AnalysisKernel::kAll),
+      fDoMinMax(kernel == AnalysisKernel::kMinMax || kernel == AnalysisKernel::kAll),
+      fDoMoments(kernel == AnalysisKernel::kMoments || kernel == AnalysisKernel::kAll),
+      fDoCut(kernel == AnalysisKernel::kCutCount || kernel == AnalysisKernel::kAll),
+      fDoHistogram(kernel == AnalysisKernel::kHistogram || kernel == AnalysisKernel::kAll),
+      fCut(cut), fLow(low), fInvWidth(bins / (high - low)), fBins(bins),
+      fMin(std::numeric_limits<float>::infinity()), fMax(-std::numeric_limits<float>::infinity()),
+      fCounts(kHistogramCopies * (bins + 2)) {}
+
+double FloatAnalysis::GetMean() const {
+    return fCount ? fShift + fShiftedSum / fCount : 0;
+}
+
+double FloatAnalysis::GetVariance() const {
+    if (fCount < 2) {return 0;}
+    return (fShiftedSum2 - fShiftedSum * fShiftedSum / fCount) / (fCount - 1);
+}
+
+std::vector<Long64_t> FloatAnalysis::GetHistogram() const {
+    std::vector<Long64_t> merged(fBins + 2);
+    for (int copy = 0; copy < kHistogramCopies; copy++) {
+        for (int bin = 0; bin < fBins + 2; bin++) {merged[bin] += fCounts[copy * (fBins + 2) + bin];}
+    }
+    return merged;
+}
+
+void FloatAnalysis::Fill(float value) {
+    FillScalar(&value, 1);
+}
+
+void FloatAnalysis::FillBatch(const float *values, size_t count, bool simd) {
+    if (!count) {return;}
+#ifdef BULKAPI_X86_KERNELS
+    static const bool have_avx2 = AnalysisSimdSupported();
+    if (simd && have_avx2) {
+        FillAVX2(values, count);
+        return;
+    }
+#endif
+    FillScalar(values, count);
+}
+
+// The scalar loops are the reference: one pass per kernel, one value at a
+// time, in the order a hand-written analysis loop would do them.  The bin
+// computation matches the vector one operation for operation so that both
+// fill the same bins; NaN goes to underflow.
+
+void FloatAnalysis::FillScalar(const float *values, size_t count) {
+    if (!fHasShift && fDoMoments) {
+        fShift = values[0];
+        fHasShift = true;
+    }
+    fCount += count;
+    if (fDoSum) {
+        double sum = 0;
+        for (size_t idx = 0; idx < count; idx++) {sum += values[idx];}
+        fSum += sum;
+    }
+    if (fDoMinMax) {
+        for (size_t idx = 0; idx < count; idx++) {
+            if (values[idx] < fMin) {fMin = values[idx];}
+            if (values[idx] > fMax) {fMax = values[idx];}
+        }
+    }
+    if (fDoMoments) {
+        double sum = 0, sum2 = 0;
+        for (size_t idx = 0; idx < count; idx++) {
+            double delta = values[idx] - fShift;
+            sum += delta;
+            sum2 += delta * delta;
+        }
+        fShiftedSum += sum;
+        fShiftedSum2 += sum2;
+    }
+    if (fDoCut) {
+        Long64_t passed = 0;
+        for (size_t idx = 0; idx < count; idx++) {
+            if (values[idx] > fCut) {passed++;}
+        }
+        fPassed += passed;
+    }
+    if (fDoHistogram) {
+        const float top = fBins;
+        for (size_t idx = 0; idx < count; idx++) {
+            float pos = (values[idx] - fLow) * fInvWidth;
+            pos = pos > -1.0f ? pos : -1.0f;
+            pos = pos < top ? pos : top;
+            fCounts[static_cast<int>(floorf(pos)) + 1]++;
+        }
+    }
+}
+
+#ifdef BULKAPI_X86_KERNELS
+
+__attribute__((target("avx2")))
+static inline double HorizontalSum(__m256d v) {
+    __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+/**
+ * All requested kernels in a single pass over the batch, eight floats at a
+ * time; sums are widened to double four lanes at a time.  The tail is
+ * handed to the scalar loops.
+ */
+__attribute__((target("avx2")))
+void FloatAnalysis::FillAVX2(const float *values, size_t count) {
+    if (!fHasShift && fDoMoments) {
+        fShift = values[0];
+        fHasShift = true;
+    }
+    size_t vectorized = count & ~static_cast<size_t>(7);
+    __m256d sum_lo = _mm256_setzero_pd(), sum_hi = _mm256_setzero_pd();
+    __m256d msum_lo = _mm256_setzero_pd(), msum_hi = _mm256_setzero_pd();
+    __m256d msum2_lo = _mm256_setzero_pd(), msum2_hi = _mm256_setzero_pd();
+    __m256 vmin = _mm256_set1_ps(fMin), vmax = _mm256_set1_ps(fMax);
+    const __m256d shift = _mm256_set1_pd(fShift);
+    const __m256 cut = _mm256_set1_ps(fCut);
+    const __m256 low = _mm256_set1_ps(fLow), inv_width = _mm256_set1_ps(fInvWidth);
+    const __m256 under = _mm256_set1_ps(-1.0f), top = _mm256_set1_ps(fBins);
+    const __m256i one = _mm256_set1_epi32(1);
+    Long64_t passed = 0;
+    alignas(32) int32_t bins[8];
+    Long64_t *counts = fCounts.data();
+    const int stride = fBins + 2;
+
+    for (size_t idx = 0; idx < vectorized; idx += 8) {
+        __m256 v = _mm256_loadu_ps(values + idx);
+        if (fDoSum) {
+            sum_lo = _mm256_add_pd(sum_lo, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+            sum_hi = _mm256_add_pd(sum_hi, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+        }
+        if (fDoMinMax) {
+            // min/max return their second operand for NaN, so NaNs are skipped as in the scalar loop.
+            vmin = _mm256_min_ps(v, vmin);
+            vmax = _mm256_max_ps(v, vmax);
+        }
+        if (fDoMoments) {
+            __m256d lo = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(v)), shift);
+            __m256d hi = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)), shift);
+            msum_lo = _mm256_add_pd(msum_lo, lo);
+            msum_hi = _mm256_add_pd(msum_hi, hi);
+            msum2_lo = _mm256_add_pd(msum2_lo, _mm256_mul_pd(lo, lo));
+            msum2_hi = _mm256_add_pd(msum2_hi, _mm256_mul_pd(hi, hi));
+        }
+        if (fDoCut) {
+            passed += __builtin_popcount(_mm256_movemask_ps(_mm256_cmp_ps(v, cut, _CMP_GT_OQ)));
+        }
+        if (fDoHistogram) {
+            // max/min return their second operand for NaN, matching the scalar clamp.
+            __m256 pos = _mm256_mul_ps(_mm256_sub_ps(v, low), inv_width);
+            pos = _mm256_min_ps(_mm256_max_ps(pos, under), top);
+            __m256i bin = _mm256_add_epi32(_mm256_cvttps_epi32(_mm256_floor_ps(pos)), one);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(bins), bin);
+            for (int lane = 0; lane < 8; lane++) {counts[(lane & (kHistogramCopies - 1)) * stride + bins[lane]]++;}
+        }
+    }
+
+    fCount += vectorized;
+    if (fDoSum) {fSum += HorizontalSum(_mm256_add_pd(sum_lo, sum_hi));}
+    if (fDoMinMax) {
+        alignas(32) float lanes[8];
+        _mm256_store_ps(lanes, vmin);
+        for (float lane : lanes) {fMin = lane < fMin ? lane : fMin;}
+        _mm256_store_ps(lanes, vmax);
+        for (float lane : lanes) {fMax = lane > fMax ? lane : fMax;}
+    }
+    if (fDoMoments) {
+        fShiftedSum += HorizontalSum(_mm256_add_pd(msum_lo, msum_hi));
+        fShiftedSum2 += HorizontalSum(_mm256_add_pd(msum2_lo, msum2_hi));
+    }
+    fPassed += passed;
+    if (vectorized < count) {FillScalar(values + vectorized, count - vectorized);}
+}
+
+#else
+
+void FloatAnalysis::FillAVX2(const float *values, size_t count) {
+    FillScalar(values, count);
+}
+
+#endif  // BULKAPI_X86_KERNELS
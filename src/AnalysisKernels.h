@@ -0,0 +1,75 @@
+#ifndef BULKAPI_ANALYSIS_KERNELS_H
+#define BULKAPI_ANALYSIS_KERNELS_H
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "Rtypes.h"
+
+/**
+ * Consumer kernels that stand in for a real analysis, so the read modes can
+ * be compared on end-to-end throughput rather than decode speed alone.
+ */
+enum class AnalysisKernel {
+    kSum,
+    kMinMax,
+    kMoments,    // Mean and variance.
+    kCutCount,   // Number of values above a cut.
+    kHistogram,  // Fixed-width 1D histogram with under- and overflow bins.
+    kAll
+};
+
+bool ParseAnalysisKernel(const char *name, AnalysisKernel &kernel);
+const char *GetAnalysisKernelName(AnalysisKernel kernel);
+
+/// True if FillBatch(..., true) has a vector implementation on this CPU.
+bool AnalysisSimdSupported();
+
+/**
+ * Accumulates the selected kernel(s) over a stream of floats.  Fill() takes
+ * one value at a time, as a TTreeReader loop would; FillBatch() takes a
+ * decoded basket and uses the AVX2 kernels when `simd` is set and the CPU
+ * has them, or the plain scalar loops otherwise.
+ *
+ * Sums are accumulated in double.  The variance is computed from sums
+ * shifted by the first value seen, which keeps the usual one-pass formula
+ * accurate when the mean is large compared to the spread.
+ */
+class FloatAnalysis {
+public:
+    FloatAnalysis(AnalysisKernel kernel, float cut, float low, float high, int bins);
+
+    void Fill(float value);
+    void FillBatch(const float *values, size_t count, bool simd);
+
+    Long64_t GetCount() const {return fCount;}
+    double GetSum() const {return fSum;}
+    float GetMin() const {return fMin;}
+    float GetMax() const {return fMax;}
+    double GetMean() const;
+    double GetVariance() const;
+    Long64_t GetPassed() const {return fPassed;}
+    /// Bin 0 is underflow (and NaN), bin `bins`+1 is overflow.
+    std::vector<Long64_t> GetHistogram() const;
+
+private:
+    void FillScalar(const float *values, size_t count);
+    void FillAVX2(const float *values, size_t count);
+
+    bool fDoSum, fDoMinMax, fDoMoments, fDoCut, fDoHistogram;
+    float fCut, fLow, fInvWidth;
+    int fBins;
+
+    Long64_t fCount{0};
+    double fSum{0};
+    float fMin, fMax;
+    bool fHasShift{false};
+    double fShift{0}, fShiftedSum{0}, fShiftedSum2{0};
+    Long64_t fPassed{0};
+    // Four interleaved copies of the histogram, so consecutive values that
+    // land in the same bin do not serialize on one counter; merged on read.
+    std::vector<Long64_t> fCounts;
+};
+
+#endif  // BULKAPI_ANALYSIS_KERNELS_H
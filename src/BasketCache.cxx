@@ -0,0 +1,83 @@
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "TBranch.h"
+#include "ROOT/TBulkBranchRead.hxx"
+
+#include "BasketCache.h"
+#include "BasketUtils.h"
+#include "ByteSwap.h"
+
+const BasketCache::Basket *BasketCache::Find(const std::string &branch, Int_t basket) {
+    auto it = fIndex.find(Key(branch, basket));
+    if (it == fIndex.end()) {
+        fMisses++;
+        return nullptr;
+    }
+    fHits++;
+    fLRU.splice(fLRU.begin(), fLRU, it->second);
+    return &it->second->second;
+}
+
+const BasketCache::Basket *BasketCache::Insert(const std::string &branch, Int_t basket, Basket &&payload) {
+    size_t bytes = payload.data.size();
+    if (bytes > fBudget) {
+        fOversized = std::move(payload);
+        return &fOversized;
+    }
+    Key key(branch, basket);
+    auto existing = fIndex.find(key);
+    if (existing != fIndex.end()) {
+        fBytes -= existing->second->second.data.size();
+        fLRU.erase(existing->second);
+        fIndex.erase(existing);
+    }
+    while (fBytes + bytes > fBudget) {
+        fBytes -= fLRU.back().second.data.size();
+        fIndex.erase(fLRU.back().first);
+        fLRU.pop_back();
+        fEvictions++;
+    }
+    fLRU.emplace_front(key, std::move(payload));
+    fIndex[key] = fLRU.begin();
+    fBytes += bytes;
+    return &fLRU.front().second;
+}
+
+CachedBulkReader::CachedBulkReader(BasketCache &cache, TBranch *branch, size_t entry_size, bool native)
+    : fCache(cache), fBranch(branch), fName(branch->GetName()), fEntrySize(entry_size), fNative(native),
+      fBoundaries(GetBasketBoundaries(branch)) {}
+
+Long64_t CachedBulkReader::GetEntries(Long64_t evt, const char *&data) {
+    if (evt >= fBoundaries.back()) {return 0;}
+    auto it = std::upper_bound(fBoundaries.begin(), fBoundaries.end(), evt);
+    Int_t basket = (it - fBoundaries.begin()) - 1;
+    const BasketCache::Basket *cached = fCache.Find(fName, basket);
+    if (!cached) {
+        Long64_t first = fBoundaries[basket];
+        Int_t count = fBranch->GetBulkRead().GetEntriesSerialized(first, fBuffer);
+        if (R__unlikely(count < 0)) {
+            printf("Failed to get entries via the 'serialized' method on branch '%s' for index %lld.\n",
+                   fName.c_str(), first);
+            return -1;
+        }
+        BasketCache::Basket payload;
+        payload.first = first;
+        payload.count = count;
+        payload.data.resize(count * fEntrySize);
+        // Swapping while copying into the cache costs no more than a plain copy.
+        if (fNative && fEntrySize == 4) {
+            DecodeBigEndian32(fBuffer.GetCurrent(), payload.data.data(), count);
+        } else if (fNative && fEntrySize == 8) {
+            DecodeBigEndian64(fBuffer.GetCurrent(), payload.data.data(), count);
+        } else {
+            memcpy(payload.data.data(), fBuffer.GetCurrent(), payload.data.size());
+        }
+        cached = fCache.Insert(fName, basket, std::move(payload));
+    }
+    data = cached->data.data() + (evt - cached->first) * fEntrySize;
+    return cached->count - (evt - cached->first);
+}
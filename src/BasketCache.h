@@ -0,0 +1,100 @@
+#ifndef BULKAPI_BASKET_CACHE_H
+#define BULKAPI_BASKET_CACHE_H
+
+#include <stddef.h>
+
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Rtypes.h"
+#include "TBufferFile.h"
+
+class TBranch;
+
+/**
+ * In-process cache of decompressed baskets, keyed by branch name and basket
+ * index, holding at most a fixed number of payload bytes.  The least
+ * recently used basket is evicted first.
+ *
+ * Keys use the branch name rather than the TBranch pointer so the cache
+ * stays valid when the file is closed and opened again between passes.
+ */
+class BasketCache {
+public:
+    struct Basket {
+        std::vector<char> data;
+        Long64_t first{0};   // First entry of the basket.
+        Long64_t count{0};   // Number of entries.
+    };
+
+    explicit BasketCache(size_t budget_bytes) : fBudget(budget_bytes) {}
+
+    /// The cached basket, or nullptr.  Valid until the next Insert().
+    const Basket *Find(const std::string &branch, Int_t basket);
+
+    /**
+     * Store a basket, evicting older ones until the cache is within budget.
+     * A basket bigger than the whole budget is not kept, but the returned
+     * pointer is still valid until the next Insert().
+     */
+    const Basket *Insert(const std::string &branch, Int_t basket, Basket &&payload);
+
+    Long64_t GetHits() const {return fHits;}
+    Long64_t GetMisses() const {return fMisses;}
+    Long64_t GetEvictions() const {return fEvictions;}
+    size_t GetBytes() const {return fBytes;}
+    size_t GetBudget() const {return fBudget;}
+
+private:
+    typedef std::pair<std::string, Int_t> Key;
+    struct KeyHash {
+        size_t operator()(const Key &key) const {
+            return std::hash<std::string>()(key.first) * 31 + std::hash<Int_t>()(key.second);
+        }
+    };
+    typedef std::list<std::pair<Key, Basket>> LRUList;
+
+    size_t fBudget;
+    size_t fBytes{0};
+    LRUList fLRU;   // Most recently used first.
+    std::unordered_map<Key, LRUList::iterator, KeyHash> fIndex;
+    Basket fOversized;
+    Long64_t fHits{0};
+    Long64_t fMisses{0};
+    Long64_t fEvictions{0};
+};
+
+/**
+ * Bulk reader for a fixed-size branch that serves baskets from a
+ * BasketCache and only calls GetEntriesSerialized on a miss.
+ *
+ * With `native` set the cache holds values already converted to native byte
+ * order, so later passes skip the swap as well as the decompression;
+ * otherwise it holds the big-endian payload and the consumer decodes it.
+ */
+class CachedBulkReader {
+public:
+    CachedBulkReader(BasketCache &cache, TBranch *branch, size_t entry_size, bool native);
+
+    /**
+     * Point `data` at the entries of the basket starting at `evt`, which must
+     * be a basket boundary.  Returns the number of entries, 0 past the end
+     * and -1 if the basket could not be read.
+     */
+    Long64_t GetEntries(Long64_t evt, const char *&data);
+
+private:
+    BasketCache &fCache;
+    TBranch *fBranch;
+    std::string fName;
+    size_t fEntrySize;
+    bool fNative;
+    std::vector<Long64_t> fBoundaries;
+    TBufferFile fBuffer{TBuffer::kWrite, 32*1024};
+};
+
+#endif  // BULKAPI_BASKET_CACHE_H
@@ -0,0 +1,139 @@
+#include <getopt.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BenchmarkContext.h"
+#include "BenchmarkResults.h"
+#include "BenchmarkRunner.h"
+#include "ReadModes.h"
+#include "WriteModes.h"
+
+/**
+ * Writes the float file with per-basket statistics ('fillstats'), then runs
+ * a range count over it at several selectivities, once scanning every
+ * basket ('rangescan') and once skipping the baskets the statistics rule
+ * out ('rangeskip').  Each rangeskip row carries the number of baskets it
+ * skipped and its speedup over the full scan at the same selectivity.
+ */
+
+static void Usage(const char *prog, const DriverOptions &defaults) {
+    fprintf(stderr, "Usage: %s [options] events fname\n", prog);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -s, --selectivities LIST Comma-separated fractions of the events selected, in (0, 1]\n");
+    fprintf(stderr, "                           (default: 0.0001,0.001,0.01,0.1,0.5,1).\n");
+    fprintf(stderr, "  -c, --compression N      ROOT compression settings, e.g. 407 or 0 (default: ROOT's).\n");
+    fprintf(stderr, "  -b, --basket-size N      Basket size in bytes (default: 320000).\n");
+    PrintDriverUsage(defaults, 24);
+}
+
+int main(int argc, char *argv[]) {
+
+    // Handle all the argument parsing up front.
+    std::vector<double> selectivities = {0.0001, 0.001, 0.01, 0.1, 0.5, 1};
+    DriverOptions driver;
+    driver.repetitions = 5;
+    const DriverOptions defaults(driver);
+    BenchmarkContext options;
+
+    static const struct option long_options[] = {
+        {"selectivities", required_argument, nullptr, 's'},
+        {"compression", required_argument, nullptr, 'c'},
+        {"basket-size", required_argument, nullptr, 'b'},
+        {"warmup", required_argument, nullptr, 'w'},
+        {"repetitions", required_argument, nullptr, 'r'},
+        {"format", required_argument, nullptr, 'f'},
+        {"output", required_argument, nullptr, 'o'},
+        {"keep", no_argument, nullptr, 'k'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "s:c:b:w:r:f:o:kh", long_options, nullptr)) != -1) {
+        OptionStatus status = ParseDriverOption(opt, optarg, driver);
+        if (status == OptionStatus::kError) {return 1;}
+        if (status == OptionStatus::kHandled) {continue;}
+        switch (opt) {
+        case 's': {
+            std::stringstream ss(optarg);
+            std::string item;
+            selectivities.clear();
+            while (std::getline(ss, item, ',')) {
+                double selectivity = 0;
+                try {
+                    selectivity = std::stod(item);
+                } catch (...) {}
+                if ((selectivity <= 0) || (selectivity > 1)) {
+                    fprintf(stderr, "Selectivities must be in (0, 1] (got %s).\n", item.c_str());
+                    return 1;
+                }
+                selectivities.push_back(selectivity);
+            }
+            break;
+        }
+        case 'c': {
+            Long64_t compression;
+            if (!ParseCount(optarg, "compression settings", compression)) {return 1;}
+            options.compression = compression;
+            break;
+        }
+        case 'b': {
+            Long64_t basket_size;
+            if (!ParseCount(optarg, "basket size", basket_size)) {return 1;}
+            options.basket_size = basket_size;
+            break;
+        }
+        case 'h':
+            Usage(argv[0], defaults);
+            return 0;
+        default:
+            Usage(argv[0], defaults);
+            return 1;
+        }
+    }
+    if (argc - optind != 2) {
+        Usage(argv[0], defaults);
+        return 1;
+    }
+    if (!ParseCount(argv[optind], "event count", options.events)) {return 1;}
+    const char *fname = argv[optind + 1];
+    options.fname = fname;
+    // End arg parsing.
+
+    BenchmarkResult written;
+    bool ok = RunMode(*FindWriteMode("fillstats"), options, 1, 0, 1, written);
+
+    std::vector<BenchmarkResult> results;
+    for (double selectivity : selectivities) {
+        if (!ok) {break;}
+        BenchmarkContext cell(options);
+        cell.selectivity = selectivity;
+        std::ostringstream label;
+        label << "sel=" << selectivity;
+
+        BenchmarkResult scan, skip;
+        ok = RunMode(*FindReadMode("rangescan"), cell, 1, driver.warmup, driver.repetitions, scan) &&
+             RunMode(*FindReadMode("rangeskip"), cell, 1, driver.warmup, driver.repetitions, skip);
+        if (!ok) {break;}
+        if (skip.GetMetric("passed") != scan.GetMetric("passed")) {
+            printf("Skipping changed the result at selectivity %g: %.0f vs. %.0f values passed.\n",
+                   selectivity, skip.GetMetric("passed"), scan.GetMetric("passed"));
+            ok = false;
+            break;
+        }
+        scan.mode = label.str() + "/" + scan.mode;
+        skip.mode = label.str() + "/" + skip.mode;
+        skip.metrics.emplace_back("speedup", skip.Median() > 0 ? scan.Median() / skip.Median() : 0);
+        results.push_back(scan);
+        results.push_back(skip);
+    }
+    if (!driver.keep) {unlink(fname);}
+    if (!ok) {return 1;}
+
+    if (!WriteResultsTo(driver.output, driver.format, fname, results)) {return 1;}
+
+    return 0;
+}
@@ -0,0 +1,62 @@
+
+#include <stdio.h>
+
+#include "TBranch.h"
+#include "TDirectory.h"
+#include "TTree.h"
+
+#include "BasketStatistics.h"
+
+static const char *kStatsLeaves = "first/L:entries/L:min/D:max/D:nans/L";
+
+BasketStatsRecorder::BasketStatsRecorder(TBranch *branch)
+    : fBranch(branch), fWriteBasket(branch->GetWriteBasket()) {
+    Reset();
+}
+
+void BasketStatsRecorder::Update() {
+    Int_t write_basket = fBranch->GetWriteBasket();
+    if (R__likely(write_basket == fWriteBasket)) {return;}
+    // Every value seen since the last update went into the basket(s) just
+    // written.  That is normally one; if a cluster flush closed several at
+    // once they share the statistics, which is conservative.
+    const Long64_t *basket_entry = fBranch->GetBasketEntry();
+    for (Int_t basket = fWriteBasket; basket < write_basket; basket++) {
+        Long64_t first = basket_entry[basket];
+        fStats.push_back({first, basket_entry[basket + 1] - first, fMin, fMax, fNaNs});
+    }
+    fWriteBasket = write_basket;
+    Reset();
+}
+
+bool BasketStatsRecorder::Write(TDirectory *dir) const {
+    std::string name = GetBasketStatsName(fBranch->GetName());
+    TTree *tree = new TTree(name.c_str(), "Per-basket value statistics");
+    tree->SetDirectory(dir);
+    BasketStat stat;
+    tree->Branch("stats", &stat, kStatsLeaves);
+    for (const auto &basket : fStats) {
+        stat = basket;
+        if (tree->Fill() < 0) {
+            printf("Failed to write basket statistics for %s.\n", fBranch->GetName());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ReadBasketStats(TDirectory *dir, const char *branch, std::vector<BasketStat> &stats) {
+    std::string name = GetBasketStatsName(branch);
+    TTree *tree = dynamic_cast<TTree*>(dir->Get(name.c_str()));
+    if (!tree) {return false;}
+    BasketStat stat;
+    tree->SetBranchAddress("stats", &stat);
+    Long64_t entries = tree->GetEntries();
+    stats.clear();
+    stats.reserve(entries);
+    for (Long64_t idx = 0; idx < entries; idx++) {
+        if (tree->GetEntry(idx) <= 0) {return false;}
+        stats.push_back(stat);
+    }
+    return true;
+}
@@ -0,0 +1,84 @@
+#ifndef BULKAPI_BASKET_STATISTICS_H
+#define BULKAPI_BASKET_STATISTICS_H
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "Rtypes.h"
+
+class TBranch;
+class TDirectory;
+
+/**
+ * Value statistics of one basket, enough to decide from the metadata alone
+ * whether any entry in it can satisfy a range predicate.  NaN values are
+ * counted in `nans` and left out of min and max.
+ */
+struct BasketStat {
+    Long64_t first;
+    Long64_t entries;
+    Double_t min;
+    Double_t max;
+    Long64_t nans;
+
+    /// False only if no value in the basket can lie in [low, high).
+    bool MayContain(double low, double high) const {return (max >= low) && (min < high);}
+};
+
+/// Name of the side tree holding the statistics of a branch.
+inline std::string GetBasketStatsName(const char *branch) {
+    return std::string(branch) + "_basketstats";
+}
+
+/**
+ * Records BasketStat for a branch while it is being filled.
+ *
+ * Call Fill() with every value as it goes into the branch and Update()
+ * after each TTree::Fill(); a basket is closed off whenever the branch's
+ * write-basket counter moves on.  Once the writing is done, flush the
+ * tree's baskets, call Update() one last time and Write() the statistics
+ * into the file as a small tree next to the data.
+ */
+class BasketStatsRecorder {
+public:
+    explicit BasketStatsRecorder(TBranch *branch);
+
+    void Fill(double value) {
+        if (R__unlikely(std::isnan(value))) {
+            fNaNs++;
+            return;
+        }
+        fMin = value < fMin ? value : fMin;
+        fMax = value > fMax ? value : fMax;
+    }
+
+    void Update();
+
+    const std::vector<BasketStat> &GetStats() const {return fStats;}
+
+    /// Store the statistics as a tree named GetBasketStatsName(branch) in `dir`.
+    bool Write(TDirectory *dir) const;
+
+private:
+    void Reset() {
+        fMin = std::numeric_limits<double>::infinity();
+        fMax = -std::numeric_limits<double>::infinity();
+        fNaNs = 0;
+    }
+
+    TBranch *fBranch;
+    Int_t fWriteBasket{0};
+    double fMin, fMax;
+    Long64_t fNaNs;
+    std::vector<BasketStat> fStats;
+};
+
+/**
+ * Load the statistics written by BasketStatsRecorder for `branch`.  Returns
+ * false if the file has none.
+ */
+bool ReadBasketStats(TDirectory *dir, const char *branch, std::vector<BasketStat> &stats);
+
+#endif  // BULKAPI_BASKET_STATISTICS_H
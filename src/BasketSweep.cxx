@@ -0,0 +1,226 @@
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BasketUtils.h"
+#include "BenchmarkContext.h"
+#include "BenchmarkResults.h"
+#include "BenchmarkRunner.h"
+#include "ReadModes.h"
+#include "WriteModes.h"
+
+/**
+ * Writes and reads the float benchmark file over a grid of basket sizes and
+ * event counts, to find where bulk-read throughput peaks relative to the
+ * cache sizes of the machine.
+ *
+ * Each result row is one (basket size, event count, read mode) cell with
+ * the number of baskets, write MB/s and peak RSS as metrics.  --gnuplot
+ * writes a script that plots read throughput, peak RSS and basket count
+ * against basket size from the CSV output.
+ */
+
+static void Usage(const char *prog, const DriverOptions &defaults) {
+    fprintf(stderr, "Usage: %s [options] fname\n", prog);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -s, --basket-sizes LIST Comma-separated basket sizes in bytes\n");
+    fprintf(stderr, "                          (default: 4096,16384,65536,262144,1048576,4194304,16777216).\n");
+    fprintf(stderr, "  -n, --events LIST       Comma-separated event counts (default: 100000 to 1000000000 in\n");
+    fprintf(stderr, "                          powers of ten; the largest file is about 4 GB).\n");
+    fprintf(stderr, "  -W, --write-mode NAME   Write mode used to create the files (default: fill).\n");
+    fprintf(stderr, "  -m, --modes LIST        Comma-separated read modes (default: standard,bulk,bulkinline).\n");
+    fprintf(stderr, "  -c, --compression N     ROOT compression settings, e.g. 407 or 0 (default: ROOT's).\n");
+    fprintf(stderr, "  -g, --gnuplot FILE      Also write a gnuplot script that plots the CSV in --output.\n");
+    PrintDriverUsage(defaults, 23);
+}
+
+static bool ParseCountList(const char *arg, const char *what, std::vector<Long64_t> &values) {
+    std::stringstream ss(arg);
+    std::string item;
+    values.clear();
+    while (std::getline(ss, item, ',')) {
+        Long64_t value;
+        if (!ParseCount(item.c_str(), what, value)) {return false;}
+        if (!value) {
+            fprintf(stderr, "%s must be positive.\n", what);
+            return false;
+        }
+        values.push_back(value);
+    }
+    return !values.empty();
+}
+
+/**
+ * gnuplot script with three panels against basket size: read MB/s, peak RSS
+ * and the number of baskets, one line per read mode and event count, all
+ * from the CSV written by this run.
+ */
+static bool WriteGnuplot(const char *script, const char *csv, const std::vector<Long64_t> &events,
+                         const std::vector<const BenchmarkMode*> &read_modes) {
+    FILE *fp = fopen(script, "w");
+    if (!fp) {
+        fprintf(stderr, "Failed to open gnuplot script %s: %s\n", script, strerror(errno));
+        return false;
+    }
+    fprintf(fp, "# Generated by basketSweep; run with: gnuplot %s\n", script);
+    fprintf(fp, "set datafile separator ','\n");
+    fprintf(fp, "set key autotitle columnhead outside right\n");
+    fprintf(fp, "set terminal pngcairo size 1200,1500\n");
+    fprintf(fp, "set output '%s.png'\n", csv);
+    fprintf(fp, "set logscale x 2\n");
+    fprintf(fp, "set xlabel 'basket size (bytes)'\n");
+    // The mode column is 'bs=<size>/ev=<events>/<mode>'; pick rows by suffix.
+    fprintf(fp, "sel(m, s) = (strstrt(m, s) > 0 && strstrt(m, s) + strlen(s) - 1 == strlen(m))\n");
+    fprintf(fp, "set multiplot layout 3,1\n");
+    const char *panels[][2] = {{"mb_per_s", "read MB/s"}, {"peak_rss_MB", "peak RSS (MB)"}, {"baskets", "baskets"}};
+    for (const auto &panel : panels) {
+        fprintf(fp, "set ylabel '%s'\n", panel[1]);
+        fprintf(fp, "plot");
+        bool first = true;
+        for (Long64_t count : events) {
+            for (const BenchmarkMode *mode : read_modes) {
+                std::string suffix = "/ev=" + std::to_string(count) + "/" + mode->name;
+                fprintf(fp, "%s \\\n  '%s' using (column('basket_size')):(sel(strcol('mode'), '%s') ? column('%s') : 1/0) "
+                        "with linespoints title '%s, %lld events'",
+                        first ? "" : ",", csv, suffix.c_str(), panel[0], mode->name, count);
+                first = false;
+            }
+        }
+        fprintf(fp, "\n");
+    }
+    fprintf(fp, "unset multiplot\n");
+    fclose(fp);
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+
+    // Handle all the argument parsing up front.
+    std::vector<Long64_t> basket_sizes = {4096, 16384, 65536, 262144, 1048576, 4194304, 16777216};
+    std::vector<Long64_t> event_counts = {100000, 1000000, 10000000, 100000000, 1000000000};
+    const BenchmarkMode *write_mode = FindWriteMode("fill");
+    std::vector<const BenchmarkMode*> read_modes;
+    DriverOptions driver;
+    // CSV by default, since that is what --gnuplot plots.
+    driver.format = ResultFormat::kCSV;
+    const DriverOptions defaults(driver);
+    const char *gnuplot = nullptr;
+    BenchmarkContext options;
+    // Peak RSS is recorded per repetition alongside the timings.
+    options.allocations = true;
+
+    static const struct option long_options[] = {
+        {"basket-sizes", required_argument, nullptr, 's'},
+        {"events", required_argument, nullptr, 'n'},
+        {"write-mode", required_argument, nullptr, 'W'},
+        {"modes", required_argument, nullptr, 'm'},
+        {"compression", required_argument, nullptr, 'c'},
+        {"warmup", required_argument, nullptr, 'w'},
+        {"repetitions", required_argument, nullptr, 'r'},
+        {"format", required_argument, nullptr, 'f'},
+        {"output", required_argument, nullptr, 'o'},
+        {"keep", no_argument, nullptr, 'k'},
+        {"gnuplot", required_argument, nullptr, 'g'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "s:n:W:m:c:w:r:f:o:kg:h", long_options, nullptr)) != -1) {
+        OptionStatus status = ParseDriverOption(opt, optarg, driver);
+        if (status == OptionStatus::kError) {return 1;}
+        if (status == OptionStatus::kHandled) {continue;}
+        switch (opt) {
+        case 's':
+            if (!ParseCountList(optarg, "basket size", basket_sizes)) {return 1;}
+            break;
+        case 'n':
+            if (!ParseCountList(optarg, "event count", event_counts)) {return 1;}
+            break;
+        case 'W':
+            write_mode = FindWriteMode(optarg);
+            if (!write_mode) {
+                fprintf(stderr, "Unknown write mode: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'm':
+            if (!ParseReadModes(optarg, read_modes)) {return 1;}
+            break;
+        case 'c': {
+            Long64_t compression;
+            if (!ParseCount(optarg, "compression settings", compression)) {return 1;}
+            options.compression = compression;
+            break;
+        }
+        case 'g':
+            gnuplot = optarg;
+            break;
+        case 'h':
+            Usage(argv[0], defaults);
+            return 0;
+        default:
+            Usage(argv[0], defaults);
+            return 1;
+        }
+    }
+    if (argc - optind != 1) {
+        Usage(argv[0], defaults);
+        return 1;
+    }
+    const char *fname = argv[optind];
+    options.fname = fname;
+    if (read_modes.empty()) {
+        for (const char *name : {"standard", "bulk", "bulkinline"}) {read_modes.push_back(FindReadMode(name));}
+    }
+    if (gnuplot && (!driver.output || driver.format != ResultFormat::kCSV)) {
+        fprintf(stderr, "--gnuplot needs CSV results written with --output.\n");
+        return 1;
+    }
+    // End arg parsing.
+
+    std::vector<BenchmarkResult> results;
+    bool ok = true;
+    for (Long64_t basket_size : basket_sizes) {
+        for (Long64_t events : event_counts) {
+            BenchmarkContext cell(options);
+            cell.basket_size = basket_size;
+            cell.events = events;
+            std::string label = "bs=" + std::to_string(basket_size) + "/ev=" + std::to_string(events);
+
+            BenchmarkResult written;
+            ok = RunMode(*write_mode, cell, 1, 0, driver.repetitions, written);
+            if (!ok) {break;}
+            struct stat st;
+            double file_bytes = stat(fname, &st) ? 0 : st.st_size;
+            Long64_t baskets = CountBaskets(fname);
+
+            for (const BenchmarkMode *mode : read_modes) {
+                BenchmarkResult result;
+                ok = RunMode(*mode, cell, 1, driver.warmup, driver.repetitions, result);
+                if (!ok) {break;}
+                result.mode = label + "/" + mode->name;
+                result.metrics.emplace_back("basket_size", basket_size);
+                result.metrics.emplace_back("baskets", baskets);
+                result.metrics.emplace_back("file_bytes", file_bytes);
+                result.metrics.emplace_back("write_MB_s", written.MBPerSecond());
+                results.push_back(result);
+            }
+            if (!ok) {break;}
+        }
+        if (!ok) {break;}
+    }
+    if (!driver.keep) {unlink(fname);}
+    if (!ok) {return 1;}
+
+    if (!WriteResultsTo(driver.output, driver.format, fname, results)) {return 1;}
+    if (gnuplot && !WriteGnuplot(gnuplot, driver.output, event_counts, read_modes)) {return 1;}
+
+    return 0;
+}
@@ -0,0 +1,58 @@
+
+#include <algorithm>
+#include <memory>
+
+#include "TBranch.h"
+#include "TFile.h"
+#include "TTree.h"
+
+#include "BasketUtils.h"
+
+std::vector<Long64_t> GetBasketBoundaries(TBranch *branch) {
+    std::vector<Long64_t> boundaries;
+    Long64_t *basket_entry = branch->GetBasketEntry();
+    Int_t nbaskets = branch->GetWriteBasket();
+    for (Int_t idx = 0; idx < nbaskets; idx++) {
+        boundaries.push_back(basket_entry[idx]);
+    }
+    Long64_t entries = branch->GetEntries();
+    if (boundaries.empty() || boundaries.back() != entries) {
+        boundaries.push_back(entries);
+    }
+    return boundaries;
+}
+
+std::vector<std::pair<Long64_t, Long64_t>> GetBasketAlignedRanges(TBranch *branch, Long64_t events, int parts) {
+    std::vector<std::pair<Long64_t, Long64_t>> ranges;
+    auto boundaries = GetBasketBoundaries(branch);
+    events = std::min(events, boundaries.back());
+    if (events <= 0 || parts <= 0) {return ranges;}
+
+    // Greedily close a range once it reaches its share of the remaining entries.
+    Long64_t first = 0;
+    size_t basket = 1;
+    for (int part = 0; part < parts && first < events; part++) {
+        Long64_t target = first + (events - first) / (parts - part);
+        while (basket < boundaries.size() - 1 && boundaries[basket] < target) {basket++;}
+        Long64_t last = (part == parts - 1) ? events : std::min(boundaries[basket], events);
+        if (last <= first) {continue;}
+        ranges.emplace_back(first, last);
+        first = last;
+    }
+    if (first < events) {
+        if (ranges.empty()) {
+            ranges.emplace_back(first, events);
+        } else {
+            ranges.back().second = events;
+        }
+    }
+    return ranges;
+}
+
+Long64_t CountBaskets(const char *fname) {
+    std::unique_ptr<TFile> hfile(TFile::Open(fname));
+    if (!hfile || hfile->IsZombie()) {return -1;}
+    TTree *tree = dynamic_cast<TTree*>(hfile->Get("T"));
+    TBranch *branch = tree ? tree->GetBranch("myFloat") : nullptr;
+    return branch ? branch->GetWriteBasket() : -1;
+}
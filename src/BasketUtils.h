@@ -0,0 +1,30 @@
+#ifndef BULKAPI_BASKET_UTILS_H
+#define BULKAPI_BASKET_UTILS_H
+
+#include <utility>
+#include <vector>
+
+#include "Rtypes.h"
+
+class TBranch;
+
+/**
+ * Returns the first entry of every basket of the branch followed by the total
+ * number of entries, so basket i covers [result[i], result[i+1]).
+ */
+std::vector<Long64_t> GetBasketBoundaries(TBranch *branch);
+
+/**
+ * Split the first `events` entries of a branch into at most `parts` contiguous
+ * ranges [first, last) that start and end on basket boundaries, each holding
+ * roughly the same number of entries.
+ */
+std::vector<std::pair<Long64_t, Long64_t>> GetBasketAlignedRanges(TBranch *branch, Long64_t events, int parts);
+
+/**
+ * Number of baskets on the myFloat branch of tree 'T' in the given file, or
+ * -1 if the file, tree or branch is missing.
+ */
+Long64_t CountBaskets(const char *fname);
+
+#endif  // BULKAPI_BASKET_UTILS_H
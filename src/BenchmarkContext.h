@@ -0,0 +1,100 @@
+#ifndef BULKAPI_BENCHMARK_CONTEXT_H
+#define BULKAPI_BENCHMARK_CONTEXT_H
+
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Rtypes.h"
+#include "TStopwatch.h"
+
+#include "AllocationCounter.h"
+#include "AnalysisKernels.h"
+#include "BufferPool.h"
+#include "PageCache.h"
+#include "PerfCounters.h"
+#include "TreeCache.h"
+
+class TFile;
+class TTree;
+
+/**
+ * Everything a single benchmark repetition needs to know about its input,
+ * plus the place it records what it measured.
+ *
+ * Modes do their setup first (constructing readers, looking up branches)
+ * and then call StartTimer(); only the work between StartTimer() and
+ * StopTimer() is attributed to the mode.
+ */
+struct BenchmarkContext {
+    TFile *file{nullptr};
+    TTree *tree{nullptr};
+    const char *fname{nullptr};
+    const char *url{nullptr};  // Opened by the read modes instead of fname when set, e.g. an http:// URL for fname.
+    Long64_t events{0};     // Number of events requested by the user.
+    int threads{1};         // Worker threads, for modes that use them.
+    int prefetch_depth{2};  // Baskets in flight, for the prefetching modes.
+    int compression{-1};    // ROOT compression settings (algorithm*100 + level) for writes; -1 keeps the default.
+    Int_t basket_size{320000};  // Basket size for writes.
+    int passes{3};          // Passes over the data, for the multi-pass modes.
+    Long64_t cache_bytes{256*1024*1024};  // Decompressed-basket cache budget, for the cached modes.
+    HugePages hugepages{HugePages::kNone};  // Backing for pooled buffers.
+    AnalysisKernel kernel{AnalysisKernel::kAll};  // Consumer run by the analysis modes.
+    double cut{std::numeric_limits<double>::quiet_NaN()};  // Cut-and-count threshold; NaN means half the events.
+    int bins{100};          // Histogram bins over the range of the benchmark values.
+    double selectivity{0.01};  // Fraction of the events the range predicate of the range modes selects.
+    PageCache page_cache{PageCache::kAsIs};  // Page cache state of ctx.fname before each read repetition.
+    bool direct_io{false};  // Read with O_DIRECT, for the modes that read the file themselves.
+    Long64_t tree_cache_bytes{-1};  // TTreeCache size for ctx.tree; -1 keeps ROOT's default, 0 disables it.
+    int cache_learn_entries{-1};  // Entries in the TTreeCache learning phase; -1 keeps ROOT's default.
+    CacheBranches cache_branches{CacheBranches::kLearn};  // Branches the TTreeCache prefetches.
+    bool io_counts{false};  // Count read syscalls and TFile read calls around each read.
+    bool phases{false};     // Split read time into I/O, decompression, deserialization and consumer phases.
+    bool counters{false};   // Read hardware performance counters around the timed region.
+    PerfCounters *perf{nullptr};  // Started and stopped with the timer when set; owned by the runner.
+    bool allocations{false};  // Snapshot the heap counters when the timer starts and stops.
+    AllocationCounts alloc_at_start;
+    AllocationCounts alloc_at_stop;
+    Long64_t bytes{0};      // Uncompressed payload bytes processed; set by the mode.
+
+    // Extra per-repetition measurements (name, value), reported alongside the timings.
+    std::vector<std::pair<std::string, double>> metrics;
+
+    void StartTimer() {
+        if (allocations) {alloc_at_start = GetAllocationCounts();}
+        if (perf) {perf->Start();}
+        fTimer.Start();
+    }
+    void StopTimer() {
+        fTimer.Stop();
+        if (perf) {perf->Stop();}
+        if (allocations) {alloc_at_stop = GetAllocationCounts();}
+    }
+    double GetRealTime() {return fTimer.RealTime();}
+    /// What read modes pass to TFile::Open.
+    const char *GetInputName() const {return url ? url : fname;}
+    void AddMetric(const std::string &name, double value) {metrics.emplace_back(name, value);}
+
+private:
+    TStopwatch fTimer;
+};
+
+/**
+ * A mode runs one timed pass over the input and returns the number of
+ * events it processed, or -1 after printing a message if the data was
+ * incorrect or unreadable.
+ */
+typedef Long64_t (*ModeFunction)(BenchmarkContext &ctx);
+
+struct BenchmarkMode {
+    const char *name;
+    const char *description;
+    ModeFunction run;
+    bool threaded{false};   // Run once per entry of --threads to produce a scaling curve.
+    bool writes{false};     // Creates ctx.fname itself rather than reading an existing file.
+    bool local{false};      // Reads ctx.fname with the OS directly, so ctx.url cannot stand in for it.
+    bool default_run{true}; // False for modes that need a particular input file; they only run when named.
+};
+
+#endif  // BULKAPI_BENCHMARK_CONTEXT_H
@@ -0,0 +1,188 @@
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+#include <set>
+
+#include "BenchmarkResults.h"
+
+double BenchmarkResult::Min() const {
+    if (times.empty()) {return 0;}
+    return *std::min_element(times.begin(), times.end());
+}
+
+double BenchmarkResult::Median() const {
+    if (times.empty()) {return 0;}
+    std::vector<double> sorted(times);
+    std::sort(sorted.begin(), sorted.end());
+    size_t mid = sorted.size() / 2;
+    if (sorted.size() % 2) {return sorted[mid];}
+    return (sorted[mid-1] + sorted[mid]) / 2;
+}
+
+double BenchmarkResult::Mean() const {
+    if (times.empty()) {return 0;}
+    double sum = 0;
+    for (auto time : times) {sum += time;}
+    return sum / times.size();
+}
+
+double BenchmarkResult::StdDev() const {
+    if (times.size() < 2) {return 0;}
+    double mean = Mean();
+    double sum2 = 0;
+    for (auto time : times) {sum2 += (time - mean) * (time - mean);}
+    return sqrt(sum2 / (times.size() - 1));
+}
+
+double BenchmarkResult::EventsPerSecond() const {
+    double median = Median();
+    return median > 0 ? events / median : 0;
+}
+
+double BenchmarkResult::MBPerSecond() const {
+    double median = Median();
+    return median > 0 ? bytes / median / 1e6 : 0;
+}
+
+double BenchmarkResult::GetMetric(const std::string &name, double fallback) const {
+    for (const auto &metric : metrics) {
+        if (metric.first == name) {return metric.second;}
+    }
+    return fallback;
+}
+
+void BenchmarkResult::AccumulateMetrics(const std::vector<std::pair<std::string, double>> &rep_metrics) {
+    for (const auto &metric : rep_metrics) {
+        auto it = std::find_if(fMetricSums.begin(), fMetricSums.end(),
+                               [&](const std::pair<std::string, double> &entry) {return entry.first == metric.first;});
+        if (it == fMetricSums.end()) {
+            fMetricSums.push_back(metric);
+        } else {
+            it->second += metric.second;
+        }
+    }
+    metrics.clear();
+    for (const auto &sum : fMetricSums) {
+        metrics.emplace_back(sum.first, sum.second / std::max<size_t>(times.size(), 1));
+    }
+}
+
+bool ParseResultFormat(const char *name, ResultFormat &format) {
+    if (!strcmp(name, "text")) {
+        format = ResultFormat::kText;
+    } else if (!strcmp(name, "json")) {
+        format = ResultFormat::kJSON;
+    } else if (!strcmp(name, "csv")) {
+        format = ResultFormat::kCSV;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static std::string JSONEscape(const std::string &input) {
+    std::string output;
+    for (char c : input) {
+        if (c == '"' || c == '\\') {
+            output += '\\';
+            output += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            output += escaped;
+        } else {
+            output += c;
+        }
+    }
+    return output;
+}
+
+static void WriteText(FILE *fp, const char *fname, const std::vector<BenchmarkResult> &results) {
+    fprintf(fp, "Results for file %s:\n", fname);
+    fprintf(fp, "%-14s %7s %12s %5s %10s %10s %10s %14s %10s\n",
+            "mode", "threads", "events", "reps", "min (s)", "median (s)", "stddev (s)", "events/s", "MB/s");
+    for (const auto &result : results) {
+        fprintf(fp, "%-14s %7d %12lld %5zu %10.4f %10.4f %10.4f %14.4g %10.1f\n",
+                result.mode.c_str(), result.threads, result.events, result.times.size(), result.Min(),
+                result.Median(), result.StdDev(), result.EventsPerSecond(), result.MBPerSecond());
+        for (const auto &metric : result.metrics) {
+            fprintf(fp, "    %-30s %g\n", metric.first.c_str(), metric.second);
+        }
+    }
+}
+
+static void WriteJSON(FILE *fp, const char *fname, const std::vector<BenchmarkResult> &results) {
+    fprintf(fp, "{\n  \"file\": \"%s\",\n  \"results\": [", JSONEscape(fname).c_str());
+    bool first_result = true;
+    for (const auto &result : results) {
+        fprintf(fp, "%s\n    {\n", first_result ? "" : ",");
+        first_result = false;
+        fprintf(fp, "      \"mode\": \"%s\",\n", JSONEscape(result.mode).c_str());
+        fprintf(fp, "      \"threads\": %d,\n", result.threads);
+        fprintf(fp, "      \"events\": %lld,\n", result.events);
+        fprintf(fp, "      \"bytes\": %lld,\n", result.bytes);
+        fprintf(fp, "      \"times\": [");
+        for (size_t idx = 0; idx < result.times.size(); idx++) {
+            fprintf(fp, "%s%.6f", idx ? ", " : "", result.times[idx]);
+        }
+        fprintf(fp, "],\n");
+        fprintf(fp, "      \"min\": %.6f,\n", result.Min());
+        fprintf(fp, "      \"median\": %.6f,\n", result.Median());
+        fprintf(fp, "      \"mean\": %.6f,\n", result.Mean());
+        fprintf(fp, "      \"stddev\": %.6f,\n", result.StdDev());
+        fprintf(fp, "      \"events_per_second\": %.6g,\n", result.EventsPerSecond());
+        fprintf(fp, "      \"mb_per_second\": %.6g,\n", result.MBPerSecond());
+        fprintf(fp, "      \"metrics\": {");
+        for (size_t idx = 0; idx < result.metrics.size(); idx++) {
+            fprintf(fp, "%s\"%s\": %.9g", idx ? ", " : "",
+                    JSONEscape(result.metrics[idx].first).c_str(), result.metrics[idx].second);
+        }
+        fprintf(fp, "}\n    }");
+    }
+    fprintf(fp, "\n  ]\n}\n");
+}
+
+static void WriteCSV(FILE *fp, const char *fname, const std::vector<BenchmarkResult> &results) {
+    // Metrics differ between modes; give every metric seen its own column.
+    std::vector<std::string> metric_names;
+    std::set<std::string> seen;
+    for (const auto &result : results) {
+        for (const auto &metric : result.metrics) {
+            if (seen.insert(metric.first).second) {metric_names.push_back(metric.first);}
+        }
+    }
+    fprintf(fp, "file,mode,threads,events,bytes,repetitions,min_s,median_s,mean_s,stddev_s,events_per_s,mb_per_s");
+    for (const auto &name : metric_names) {fprintf(fp, ",%s", name.c_str());}
+    fprintf(fp, "\n");
+    for (const auto &result : results) {
+        fprintf(fp, "%s,%s,%d,%lld,%lld,%zu,%.6f,%.6f,%.6f,%.6f,%.6g,%.6g", fname, result.mode.c_str(),
+                result.threads, result.events, result.bytes, result.times.size(), result.Min(), result.Median(),
+                result.Mean(), result.StdDev(), result.EventsPerSecond(), result.MBPerSecond());
+        for (const auto &name : metric_names) {
+            auto it = std::find_if(result.metrics.begin(), result.metrics.end(),
+                                   [&](const std::pair<std::string, double> &entry) {return entry.first == name;});
+            if (it == result.metrics.end()) {
+                fprintf(fp, ",");
+            } else {
+                fprintf(fp, ",%.9g", it->second);
+            }
+        }
+        fprintf(fp, "\n");
+    }
+}
+
+void WriteResults(FILE *fp, ResultFormat format, const char *fname, const std::vector<BenchmarkResult> &results) {
+    switch (format) {
+    case ResultFormat::kText:
+        WriteText(fp, fname, results);
+        break;
+    case ResultFormat::kJSON:
+        WriteJSON(fp, fname, results);
+        break;
+    case ResultFormat::kCSV:
+        WriteCSV(fp, fname, results);
+        break;
+    }
+}
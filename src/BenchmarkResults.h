@@ -0,0 +1,56 @@
+#ifndef BULKAPI_BENCHMARK_RESULTS_H
+#define BULKAPI_BENCHMARK_RESULTS_H
+
+#include <stdio.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Rtypes.h"
+
+/**
+ * The timings of all repetitions of one mode, plus summary statistics.
+ *
+ * Rates are computed from the median repetition so a single slow run
+ * (page faults, a noisy neighbour) does not skew the headline number.
+ */
+struct BenchmarkResult {
+    std::string mode;
+    int threads{1};
+    Long64_t events{0};
+    Long64_t bytes{0};
+    std::vector<double> times;   // Seconds, one per timed repetition.
+
+    // Per-repetition metrics reported by the mode, averaged over all repetitions.
+    std::vector<std::pair<std::string, double>> metrics;
+
+    double Min() const;
+    double Median() const;
+    double Mean() const;
+    double StdDev() const;
+    double EventsPerSecond() const;
+    double MBPerSecond() const;
+
+    /// The averaged value of a metric, or `fallback` if the mode did not report it.
+    double GetMetric(const std::string &name, double fallback = 0) const;
+
+    /// Fold one repetition's metrics into the running averages.
+    void AccumulateMetrics(const std::vector<std::pair<std::string, double>> &rep_metrics);
+
+private:
+    std::vector<std::pair<std::string, double>> fMetricSums;
+};
+
+enum class ResultFormat {
+    kText,
+    kJSON,
+    kCSV
+};
+
+/// Returns false if the format name is not one of 'text', 'json' or 'csv'.
+bool ParseResultFormat(const char *name, ResultFormat &format);
+
+void WriteResults(FILE *fp, ResultFormat format, const char *fname, const std::vector<BenchmarkResult> &results);
+
+#endif  // BULKAPI_BENCHMARK_RESULTS_H
@@ -0,0 +1,323 @@
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "TFile.h"
+#include "TTree.h"
+#include "TTreePerfStats.h"
+
+#include "AllocationCounter.h"
+#include "BenchmarkRunner.h"
+#include "PageCache.h"
+#include "PerfCounters.h"
+#include "ReadModes.h"
+#include "TreeCache.h"
+
+static double FindMetric(const BenchmarkContext &ctx, const char *name, double fallback) {
+    for (const auto &metric : ctx.metrics) {
+        if (metric.first == name) {return metric.second;}
+    }
+    return fallback;
+}
+
+/**
+ * Turn ROOT's I/O accounting into phase metrics.  TTreePerfStats only sees
+ * reads through ctx.tree, so modes that open their own file (bulkprefetch)
+ * record no read calls and get nothing added.
+ *
+ * Bulk modes time their GetEntries* calls as fetch_s; what is left of that
+ * after disk and unzip time is buffer setup and copying.  Per-event readers
+ * interleave deserialization with the consumer, so for them the remainder of
+ * the timed region is reported as one number.
+ */
+static void AddPhaseMetrics(const TTreePerfStats &perf, BenchmarkContext &ctx) {
+    if (perf.GetReadCalls() == 0) {return;}
+    double disk = perf.GetDiskTime();
+    double unzip = perf.GetUnzipTime();
+    double baskets = FindMetric(ctx, "baskets", 0);
+    double fetch = FindMetric(ctx, "fetch_s", -1);
+    ctx.AddMetric("read_calls", perf.GetReadCalls());
+    ctx.AddMetric("bytes_read", perf.GetBytesRead());
+    ctx.AddMetric("disk_s", disk);
+    ctx.AddMetric("unzip_s", unzip);
+    if (fetch >= 0) {
+        ctx.AddMetric("deserialize_s", std::max(fetch - disk - unzip, 0.0));
+    } else {
+        ctx.AddMetric("deserialize_consumer_s", std::max(ctx.GetRealTime() - disk - unzip, 0.0));
+    }
+    if (baskets > 0) {
+        ctx.AddMetric("disk_us_per_basket", 1e6 * disk / baskets);
+        ctx.AddMetric("unzip_us_per_basket", 1e6 * unzip / baskets);
+        ctx.AddMetric("read_calls_per_basket", perf.GetReadCalls() / baskets);
+    }
+}
+
+/**
+ * Read syscalls of the whole process (so threaded modes and modes that open
+ * their own file are covered) and the read calls TFile made for ctx.file.
+ * Bytes per call is what a TTreeCache should raise.
+ */
+static void AddReadCallMetrics(const ReadSyscallCounts &before, Int_t file_calls_before, Long64_t file_bytes_before,
+                               BenchmarkContext &ctx) {
+    ReadSyscallCounts after;
+    if (GetReadSyscallCounts(after)) {
+        Long64_t calls = after.calls - before.calls;
+        ctx.AddMetric("read_syscalls", calls);
+        ctx.AddMetric("bytes_per_syscall", calls ? static_cast<double>(after.bytes - before.bytes) / calls : 0);
+    }
+    Int_t file_calls = ctx.file->GetReadCalls() - file_calls_before;
+    ctx.AddMetric("file_read_calls", file_calls);
+    ctx.AddMetric("bytes_per_file_read", file_calls ? static_cast<double>(ctx.file->GetBytesRead() - file_bytes_before) / file_calls : 0);
+}
+
+/**
+ * Report each counter per event and per uncompressed byte, plus IPC.  The
+ * first repetition that finds no counters says so once on stderr.
+ */
+static void AddCounterMetrics(const PerfCounters &perf, Long64_t events, BenchmarkContext &ctx) {
+    static bool warned = false;
+    if (!warned && !perf.GetUnavailable().empty()) {
+        std::string names;
+        for (const auto &name : perf.GetUnavailable()) {names += (names.empty() ? "" : ", ") + name;}
+        fprintf(stderr, "Hardware counters unavailable (see perf_event_paranoid): %s\n", names.c_str());
+        warned = true;
+    }
+    double cycles = 0, instructions = 0;
+    for (const auto &count : perf.GetCounts()) {
+        if (count.first == "cycles") {cycles = count.second;}
+        if (count.first == "instructions") {instructions = count.second;}
+        if (events > 0) {ctx.AddMetric(count.first + "_per_event", count.second / events);}
+        if (ctx.bytes > 0) {ctx.AddMetric(count.first + "_per_byte", count.second / ctx.bytes);}
+    }
+    if (cycles > 0) {ctx.AddMetric("ipc", instructions / cycles);}
+}
+
+/**
+ * Split the heap activity of one repetition at the timer: everything before
+ * StartTimer() (opening the file, building readers) is setup, everything
+ * between StartTimer() and StopTimer() is steady state.
+ */
+static void AddAllocationMetrics(const AllocationCounts &before, Long64_t events, BenchmarkContext &ctx) {
+    static bool warned = false;
+    Long64_t rss = GetPeakRSS();
+    if (rss >= 0) {ctx.AddMetric("peak_rss_MB", rss / 1e6);}
+    if (!AllocationCountingActive()) {
+        if (!warned) {fprintf(stderr, "Allocation counting is not linked into this executable.\n");}
+        warned = true;
+        return;
+    }
+    const AllocationCounts &start = ctx.alloc_at_start, &stop = ctx.alloc_at_stop;
+    Long64_t steady = stop.allocations - start.allocations;
+    ctx.AddMetric("setup_allocs", start.allocations - before.allocations);
+    ctx.AddMetric("setup_alloc_bytes", start.bytes - before.bytes);
+    ctx.AddMetric("steady_allocs", steady);
+    ctx.AddMetric("steady_alloc_bytes", stop.bytes - start.bytes);
+    if (events > 0) {ctx.AddMetric("steady_allocs_per_event", static_cast<double>(steady) / events);}
+    ctx.AddMetric("peak_heap_MB", GetPeakLiveBytes() / 1e6);
+}
+
+static Long64_t RunCounted(const BenchmarkMode &mode, BenchmarkContext &ctx);
+static Long64_t RunMeasured(const BenchmarkMode &mode, BenchmarkContext &ctx);
+
+Long64_t RunOnce(const BenchmarkMode &mode, BenchmarkContext &ctx) {
+    if (!ctx.allocations) {return RunCounted(mode, ctx);}
+    ResetPeakLiveBytes();
+    ResetPeakRSS();
+    AllocationCounts before = GetAllocationCounts();
+    // Modes that never start the timer report no steady-state activity.
+    ctx.alloc_at_start = ctx.alloc_at_stop = before;
+    Long64_t result = RunCounted(mode, ctx);
+    if (result >= 0) {AddAllocationMetrics(before, result, ctx);}
+    return result;
+}
+
+static Long64_t RunCounted(const BenchmarkMode &mode, BenchmarkContext &ctx) {
+    if (!ctx.counters) {return RunMeasured(mode, ctx);}
+    // Opened per repetition so that threads the mode starts inherit them.
+    PerfCounters perf;
+    ctx.perf = perf.IsAvailable() ? &perf : nullptr;
+    Long64_t result = RunMeasured(mode, ctx);
+    ctx.perf = nullptr;
+    if (result >= 0) {AddCounterMetrics(perf, result, ctx);}
+    return result;
+}
+
+static Long64_t RunMeasured(const BenchmarkMode &mode, BenchmarkContext &ctx) {
+    if (mode.writes) {return mode.run(ctx);}
+    if (ctx.url && mode.local) {
+        fprintf(stderr, "Mode %s reads the local file directly and cannot read %s.\n", mode.name, ctx.url);
+        return -1;
+    }
+    // Before the open, so the header and seek-table reads see the same state as the timed ones.
+    double resident;
+    if (!PreparePageCache(ctx.fname, ctx.page_cache, resident)) {return -1;}
+    if (resident >= 0) {ctx.AddMetric("resident_fraction", resident);}
+    std::unique_ptr<TFile> hfile(TFile::Open(ctx.GetInputName()));
+    if (!hfile || hfile->IsZombie()) {
+        fprintf(stderr, "Failed to open file %s.\n", ctx.GetInputName());
+        return -1;
+    }
+    TTree *tree = dynamic_cast<TTree*>(hfile->Get("T"));
+    if (!tree) {
+        fprintf(stderr, "Failed to fetch tree named 'T' from input file.\n");
+        return -1;
+    }
+    if (!ConfigureTreeCache(tree, ctx.tree_cache_bytes, ctx.cache_learn_entries, ctx.cache_branches)) {return -1;}
+    ctx.file = hfile.get();
+    ctx.tree = tree;
+    static bool warned = false;
+    ReadSyscallCounts syscalls;
+    if (ctx.io_counts && !GetReadSyscallCounts(syscalls) && !warned) {
+        fprintf(stderr, "Read syscall counts are unavailable (no /proc/self/io).\n");
+        warned = true;
+    }
+    Int_t file_calls = hfile->GetReadCalls();
+    Long64_t file_bytes = hfile->GetBytesRead();
+    // gPerfStats is process-wide, so leave it alone while several threads read.
+    std::unique_ptr<TTreePerfStats> perf;
+    if (ctx.phases && !mode.threaded) {perf.reset(new TTreePerfStats("ioperf", tree));}
+    Long64_t result = mode.run(ctx);
+    if (ctx.io_counts && (result >= 0)) {AddReadCallMetrics(syscalls, file_calls, file_bytes, ctx);}
+    if (perf) {
+        if (result >= 0) {AddPhaseMetrics(*perf, ctx);}
+        tree->SetPerfStats(nullptr);
+    }
+    ctx.tree = nullptr;
+    ctx.file = nullptr;
+    return result;
+}
+
+bool RunMode(const BenchmarkMode &mode, const BenchmarkContext &options, int threads,
+             Long64_t warmup, Long64_t repetitions, BenchmarkResult &result) {
+    fprintf(stderr, "Running mode %s with %d thread(s) (%lld warmup, %lld timed repetitions).\n",
+            mode.name, threads, warmup, repetitions);
+    result.mode = mode.name;
+    result.threads = threads;
+    for (Long64_t rep = 0; rep < warmup + repetitions; rep++) {
+        BenchmarkContext ctx(options);
+        ctx.threads = threads;
+        Long64_t count = RunOnce(mode, ctx);
+        if (count < 0) {
+            fprintf(stderr, "Mode %s failed.\n", mode.name);
+            return false;
+        }
+        if (rep < warmup) {continue;}
+        result.events = count;
+        result.bytes = ctx.bytes;
+        result.times.push_back(ctx.GetRealTime());
+        result.AccumulateMetrics(ctx.metrics);
+    }
+    return true;
+}
+
+bool ParseCount(const char *arg, const char *what, Long64_t &value) {
+    try {
+        value = std::stoll(arg);
+    } catch (...) {
+        fprintf(stderr, "Failed to parse %s (%s) to integer.\n", what, arg);
+        return false;
+    }
+    if (value < 0) {
+        fprintf(stderr, "%s must be non-negative (got %s).\n", what, arg);
+        return false;
+    }
+    return true;
+}
+
+std::string CacheSizeLabel(Long64_t bytes) {
+    if (bytes < 0) {return "default";}
+    if (!bytes) {return "off";}
+    return std::to_string(bytes);
+}
+
+OptionStatus ParseDriverOption(int opt, const char *arg, DriverOptions &options) {
+    switch (opt) {
+    case 'w':
+        if (!ParseCount(arg, "warmup count", options.warmup)) {return OptionStatus::kError;}
+        return OptionStatus::kHandled;
+    case 'r':
+        if (!ParseCount(arg, "repetition count", options.repetitions)) {return OptionStatus::kError;}
+        if (!options.repetitions) {
+            fprintf(stderr, "At least one repetition is required.\n");
+            return OptionStatus::kError;
+        }
+        return OptionStatus::kHandled;
+    case 'f':
+        if (!ParseResultFormat(arg, options.format)) {
+            fprintf(stderr, "Output format must be 'text', 'json', or 'csv'\n");
+            return OptionStatus::kError;
+        }
+        return OptionStatus::kHandled;
+    case 'o':
+        options.output = arg;
+        return OptionStatus::kHandled;
+    case 'k':
+        options.keep = true;
+        return OptionStatus::kHandled;
+    default:
+        return OptionStatus::kUnknown;
+    }
+}
+
+void PrintDriverUsage(const DriverOptions &defaults, int width) {
+    const char *format = "text";
+    if (defaults.format == ResultFormat::kJSON) {format = "json";}
+    else if (defaults.format == ResultFormat::kCSV) {format = "csv";}
+    fprintf(stderr, "  %-*s Untimed warmup repetitions of each read (default: %lld).\n",
+            width, "-w, --warmup N", defaults.warmup);
+    fprintf(stderr, "  %-*s Timed repetitions of each run (default: %lld).\n",
+            width, "-r, --repetitions N", defaults.repetitions);
+    fprintf(stderr, "  %-*s Output format: text, json or csv (default: %s).\n",
+            width, "-f, --format FMT", format);
+    fprintf(stderr, "  %-*s Write results to FILE instead of stdout.\n",
+            width, "-o, --output FILE");
+    fprintf(stderr, "  %-*s Keep the generated file (default: delete after reading).\n",
+            width, "-k, --keep");
+}
+
+bool ParseReadModes(const char *arg, std::vector<const BenchmarkMode*> &modes) {
+    std::stringstream ss(arg);
+    std::string name;
+    while (std::getline(ss, name, ',')) {
+        const BenchmarkMode *mode = FindReadMode(name);
+        if (!mode) {
+            fprintf(stderr, "Unknown read mode: %s\n", name.c_str());
+            return false;
+        }
+        modes.push_back(mode);
+    }
+    return true;
+}
+
+bool ParseCacheSizes(const char *arg, std::vector<Long64_t> &sizes) {
+    std::stringstream ss(arg);
+    std::string item;
+    sizes.clear();
+    while (std::getline(ss, item, ',')) {
+        Long64_t bytes = -1;
+        if ((item != "default") && !ParseCount(item.c_str(), "cache size", bytes)) {return false;}
+        sizes.push_back(bytes);
+    }
+    return true;
+}
+
+bool WriteResultsTo(const char *output, ResultFormat format, const char *fname,
+                    const std::vector<BenchmarkResult> &results) {
+    FILE *fp = stdout;
+    if (output) {
+        fp = fopen(output, "w");
+        if (!fp) {
+            fprintf(stderr, "Failed to open output file %s: %s\n", output, strerror(errno));
+            return false;
+        }
+    }
+    WriteResults(fp, format, fname, results);
+    if (fp != stdout) {fclose(fp);}
+    return true;
+}
@@ -0,0 +1,82 @@
+#ifndef BULKAPI_BENCHMARK_RUNNER_H
+#define BULKAPI_BENCHMARK_RUNNER_H
+
+#include <string>
+#include <vector>
+
+#include "Rtypes.h"
+
+#include "BenchmarkContext.h"
+#include "BenchmarkResults.h"
+
+/**
+ * Run one repetition of a mode.  Read modes get ctx.fname opened fresh, so
+ * no reader or basket state leaks from one repetition into the next; write
+ * modes create the file themselves.  With ctx.phases set, ROOT's disk and
+ * decompression times are added to the mode's metrics, and with ctx.counters
+ * set, hardware counters per event and per byte; with ctx.allocations set,
+ * heap allocations split into setup and steady state.  Returns the mode's
+ * event count, or -1.
+ */
+Long64_t RunOnce(const BenchmarkMode &mode, BenchmarkContext &ctx);
+
+/**
+ * Run `warmup` untimed and then `repetitions` timed repetitions of a mode,
+ * each with a copy of `options`, and collect the timings into `result`.
+ * Progress goes to stderr so stdout stays machine-readable.
+ */
+bool RunMode(const BenchmarkMode &mode, const BenchmarkContext &options, int threads,
+             Long64_t warmup, Long64_t repetitions, BenchmarkResult &result);
+
+/**
+ * Parse a non-negative integer command-line argument into `value`, naming it
+ * as `what` in the message printed on failure.
+ */
+bool ParseCount(const char *arg, const char *what, Long64_t &value);
+
+/**
+ * Options every sweep driver shares: -w/--warmup, -r/--repetitions,
+ * -f/--format, -o/--output and -k/--keep.  Drivers set their own defaults
+ * before parsing.
+ */
+struct DriverOptions {
+    Long64_t warmup{1};
+    Long64_t repetitions{3};
+    ResultFormat format{ResultFormat::kText};
+    const char *output{nullptr};
+    bool keep{false};
+};
+
+enum class OptionStatus {
+    kHandled,
+    kUnknown,
+    kError
+};
+
+/**
+ * Parse getopt's `opt` and `arg` into `options` if it is one of the shared
+ * driver options.  kUnknown leaves the option to the driver's own switch;
+ * on kError a message has already been printed.
+ */
+OptionStatus ParseDriverOption(int opt, const char *arg, DriverOptions &options);
+
+/// Print the usage lines of the shared driver options, with the option column `width` wide.
+void PrintDriverUsage(const DriverOptions &defaults, int width);
+
+/// Parse a comma-separated list of read mode names into `modes`, appending.
+bool ParseReadModes(const char *arg, std::vector<const BenchmarkMode*> &modes);
+
+/// Parse a comma-separated list of TTreeCache sizes in bytes, "default" meaning -1 (ROOT's own size).
+bool ParseCacheSizes(const char *arg, std::vector<Long64_t> &sizes);
+
+/**
+ * Write `results` to the file `output`, or to stdout when it is null.
+ * Returns false, with a message, if the file cannot be opened.
+ */
+bool WriteResultsTo(const char *output, ResultFormat format, const char *fname,
+                    const std::vector<BenchmarkResult> &results);
+
+/// Label for a TTreeCache size in result names: "default" when negative, "off" when zero.
+std::string CacheSizeLabel(Long64_t bytes);
+
+#endif  // BULKAPI_BENCHMARK_RUNNER_H
@@ -0,0 +1,157 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "BufferPool.h"
+
+static const size_t kAlignment = 64;
+static const size_t kMinSize = 4096;
+static const size_t kHugePageSize = 2*1024*1024;
+
+bool ParseHugePages(const char *name, HugePages &mode) {
+    if (!strcmp(name, "none")) {
+        mode = HugePages::kNone;
+    } else if (!strcmp(name, "thp")) {
+        mode = HugePages::kTransparent;
+    } else if (!strcmp(name, "explicit")) {
+        mode = HugePages::kExplicit;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char *GetHugePagesName(HugePages mode) {
+    switch (mode) {
+    case HugePages::kNone:
+        return "none";
+    case HugePages::kTransparent:
+        return "thp";
+    case HugePages::kExplicit:
+        return "explicit";
+    }
+    return "unknown";
+}
+
+BufferPool &BufferPool::Get() {
+    static BufferPool pool;
+    return pool;
+}
+
+BufferPool::~BufferPool() {
+    for (const auto &block : fBlocks) {
+        if (block.second.backing == HugePages::kNone) {
+            free(block.first);
+        } else {
+            munmap(block.first, block.second.size);
+        }
+    }
+}
+
+void BufferPool::SetHugePages(HugePages mode) {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fMode = mode;
+}
+
+HugePages BufferPool::GetHugePages() const {
+    std::lock_guard<std::mutex> lock(fMutex);
+    return fMode;
+}
+
+size_t BufferPool::SizeClass(size_t bytes, HugePages mode) {
+    if (mode != HugePages::kNone) {
+        return ((bytes + kHugePageSize - 1) / kHugePageSize) * kHugePageSize;
+    }
+    size_t size = kMinSize;
+    while (size < bytes) {size *= 2;}
+    return size;
+}
+
+char *BufferPool::Allocate(size_t size, HugePages &backing) {
+    if (backing == HugePages::kNone) {
+        void *buf = nullptr;
+        return posix_memalign(&buf, kAlignment, size) ? nullptr : static_cast<char*>(buf);
+    }
+#ifdef MAP_HUGETLB
+    if (backing == HugePages::kExplicit) {
+        void *buf = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (buf != MAP_FAILED) {return static_cast<char*>(buf);}
+    }
+#endif
+    if (backing == HugePages::kExplicit) {
+        // No reserved huge pages (see /proc/sys/vm/nr_hugepages); ask for transparent ones instead.
+        fFallbacks++;
+        backing = HugePages::kTransparent;
+    }
+    void *buf = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf == MAP_FAILED) {return nullptr;}
+#ifdef MADV_HUGEPAGE
+    madvise(buf, size, MADV_HUGEPAGE);
+#endif
+    return static_cast<char*>(buf);
+}
+
+char *BufferPool::Acquire(size_t bytes) {
+    std::lock_guard<std::mutex> lock(fMutex);
+    size_t size = SizeClass(bytes, fMode);
+    // An explicit request may have been served by a transparent fallback; either will do.
+    for (HugePages backing : {fMode, HugePages::kTransparent}) {
+        auto it = fFree.find(FreeKey(size, backing));
+        if (it != fFree.end() && !it->second.empty()) {
+            char *buf = it->second.back();
+            it->second.pop_back();
+            fReuses++;
+            return buf;
+        }
+        if (fMode != HugePages::kExplicit) {break;}
+    }
+    HugePages backing = fMode;
+    char *buf = Allocate(size, backing);
+    if (!buf) {return nullptr;}
+    fBlocks[buf] = {size, backing};
+    fAllocations++;
+    return buf;
+}
+
+bool BufferPool::Release(char *buf) {
+    std::lock_guard<std::mutex> lock(fMutex);
+    auto it = fBlocks.find(buf);
+    if (it == fBlocks.end()) {return false;}
+    fFree[FreeKey(it->second.size, it->second.backing)].push_back(buf);
+    return true;
+}
+
+char *BufferPool::Realloc(char *old, size_t new_size, size_t old_size) {
+    BufferPool &pool = Get();
+    char *buf = pool.Acquire(new_size);
+    if (!buf) {return nullptr;}
+    if (old) {
+        memcpy(buf, old, old_size < new_size ? old_size : new_size);
+        pool.Release(old);
+    }
+    return buf;
+}
+
+Long64_t BufferPool::GetAllocations() const {
+    std::lock_guard<std::mutex> lock(fMutex);
+    return fAllocations;
+}
+
+Long64_t BufferPool::GetReuses() const {
+    std::lock_guard<std::mutex> lock(fMutex);
+    return fReuses;
+}
+
+Long64_t BufferPool::GetHugePageFallbacks() const {
+    std::lock_guard<std::mutex> lock(fMutex);
+    return fFallbacks;
+}
+
+// The buffer is not adopted: ROOT would free it with delete[], and the pool has to get it back instead.
+PooledBufferFile::PooledBufferFile(Int_t bufsize)
+    : TBufferFile(TBuffer::kWrite, bufsize, BufferPool::Get().Acquire(bufsize), kFALSE, BufferPool::Realloc) {}
+
+PooledBufferFile::~PooledBufferFile() {
+    BufferPool::Get().Release(Buffer());
+}
@@ -0,0 +1,88 @@
+#ifndef BULKAPI_BUFFER_POOL_H
+#define BULKAPI_BUFFER_POOL_H
+
+#include <stddef.h>
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "Rtypes.h"
+#include "TBufferFile.h"
+
+enum class HugePages {
+    kNone,          // posix_memalign, 64-byte aligned.
+    kTransparent,   // Anonymous mapping in 2 MiB multiples with MADV_HUGEPAGE.
+    kExplicit       // MAP_HUGETLB from the reserved pool; falls back to kTransparent.
+};
+
+/// Returns false if the name is not one of 'none', 'thp' or 'explicit'.
+bool ParseHugePages(const char *name, HugePages &mode);
+const char *GetHugePagesName(HugePages mode);
+
+/**
+ * Process-wide pool of 64-byte-aligned buffers, shared by every branch and
+ * thread.
+ *
+ * Sizes are rounded up to a power of two (at least 4 KiB, or whole 2 MiB
+ * pages when huge pages are requested) and released buffers wait on a free
+ * list for the next request of the same size and backing, so a steady-state
+ * read loop allocates nothing.  Memory only goes back to the system when the
+ * process exits.
+ */
+class BufferPool {
+public:
+    static BufferPool &Get();
+
+    /// Backing used for buffers acquired from now on.
+    void SetHugePages(HugePages mode);
+    HugePages GetHugePages() const;
+
+    /// A buffer of at least `bytes`; nullptr if the system is out of memory.
+    char *Acquire(size_t bytes);
+    /// Returns false, and does nothing, if `buf` did not come from the pool.
+    bool Release(char *buf);
+
+    /**
+     * ReAllocCharFun_t for a TBufferFile over pooled memory: ROOT calls it
+     * when the buffer has to grow while a basket is decompressed into it.
+     */
+    static char *Realloc(char *old, size_t new_size, size_t old_size);
+
+    Long64_t GetAllocations() const;    // Buffers obtained from the system.
+    Long64_t GetReuses() const;         // Requests served from a free list.
+    Long64_t GetHugePageFallbacks() const;
+
+private:
+    BufferPool() = default;
+    ~BufferPool();
+
+    struct Block {
+        size_t size;
+        HugePages backing;
+    };
+    char *Allocate(size_t size, HugePages &backing);
+    static size_t SizeClass(size_t bytes, HugePages mode);
+    static size_t FreeKey(size_t size, HugePages backing) {return size * 4 + static_cast<size_t>(backing);}
+
+    mutable std::mutex fMutex;
+    HugePages fMode{HugePages::kNone};
+    std::unordered_map<char*, Block> fBlocks;   // Every buffer the pool owns.
+    std::unordered_map<size_t, std::vector<char*>> fFree;
+    Long64_t fAllocations{0};
+    Long64_t fReuses{0};
+    Long64_t fFallbacks{0};
+};
+
+/**
+ * A TBufferFile whose memory comes from the BufferPool, and grows through
+ * it, so a basket read into it lands in pooled memory.  The memory goes
+ * back to the pool on destruction.
+ */
+class PooledBufferFile : public TBufferFile {
+public:
+    explicit PooledBufferFile(Int_t bufsize);
+    ~PooledBufferFile();
+};
+
+#endif  // BULKAPI_BUFFER_POOL_H
@@ -0,0 +1,317 @@
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BenchmarkContext.h"
+#include "BenchmarkResults.h"
+#include "BenchmarkRunner.h"
+#include "ReadModes.h"
+#include "WriteModes.h"
+
+static void Usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [options] events fname\n", prog);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -m, --modes LIST        Comma-separated modes to run (default: every read mode not marked\n");
+    fprintf(stderr, "                          'named only', which need a particular input file).\n");
+    fprintf(stderr, "  -w, --warmup N          Untimed warmup repetitions per mode (default: 1).\n");
+    fprintf(stderr, "  -r, --repetitions N     Timed repetitions per mode (default: 5).\n");
+    fprintf(stderr, "  -f, --format FMT        Output format: text, json or csv (default: text).\n");
+    fprintf(stderr, "  -o, --output FILE       Write results to FILE instead of stdout.\n");
+    fprintf(stderr, "  -t, --threads LIST      Comma-separated thread counts for threaded modes (default: 1).\n");
+    fprintf(stderr, "  -d, --depth N           Baskets in flight for the prefetching modes (default: 2).\n");
+    fprintf(stderr, "  -c, --compression N     ROOT compression settings for write modes, e.g. 407 or 0 (default: ROOT's).\n");
+    fprintf(stderr, "  -b, --basket-size N     Basket size in bytes for write modes (default: 320000).\n");
+    fprintf(stderr, "  -P, --passes N          Passes over the data for the cached modes (default: 3).\n");
+    fprintf(stderr, "  -C, --cache-size MB     Basket cache budget for the cached modes (default: 256).\n");
+    fprintf(stderr, "  -H, --hugepages MODE    Backing for bulkpooled buffers: none, thp or explicit (default: none).\n");
+    fprintf(stderr, "  -k, --kernel NAME       Consumer for the analysis modes: sum, minmax, moments, cut,\n");
+    fprintf(stderr, "                          histogram or all (default: all).\n");
+    fprintf(stderr, "  -x, --cut X             Cut for the cut kernel (default: half the number of events).\n");
+    fprintf(stderr, "  -B, --bins N            Bins of the histogram kernel (default: 100).\n");
+    fprintf(stderr, "  -S, --selectivity X     Fraction of the events the range modes select, in (0, 1] (default: 0.01).\n");
+    fprintf(stderr, "  -K, --page-cache LIST   Comma-separated page cache states for read modes: asis, cold\n");
+    fprintf(stderr, "                          (evicted first) or warm (read in full first); each state is a\n");
+    fprintf(stderr, "                          separate result row (default: asis).\n");
+    fprintf(stderr, "  -D, --direct-io         Read with O_DIRECT in the modes that read the file themselves\n");
+    fprintf(stderr, "                          (rawio, parallelunzip).\n");
+    fprintf(stderr, "  -p, --phases            Split read time into disk, decompression, deserialization and consumer phases.\n");
+    fprintf(stderr, "  -a, --allocations       Report heap allocations (setup vs. steady state) and peak memory.\n");
+    fprintf(stderr, "  -e, --counters          Report hardware performance counters per event and per byte.\n");
+    fprintf(stderr, "Read modes:\n");
+    for (const auto &mode : GetReadModes()) {
+        fprintf(stderr, "  %-22s  %s%s\n", mode.name, mode.description, mode.default_run ? "" : " (named only)");
+    }
+    fprintf(stderr, "Write modes (these overwrite fname):\n");
+    for (const auto &mode : GetWriteModes()) {
+        fprintf(stderr, "  %-22s  %s\n", mode.name, mode.description);
+    }
+}
+
+int main(int argc, char *argv[]) {
+
+    // Handle all the argument parsing up front.
+    std::vector<const BenchmarkMode*> modes;
+    Long64_t warmup = 1, repetitions = 5;
+    ResultFormat format = ResultFormat::kText;
+    const char *output = nullptr;
+    std::vector<int> thread_counts;
+    std::vector<PageCache> page_caches;
+    BenchmarkContext options;
+
+    static const struct option long_options[] = {
+        {"modes", required_argument, nullptr, 'm'},
+        {"warmup", required_argument, nullptr, 'w'},
+        {"repetitions", required_argument, nullptr, 'r'},
+        {"format", required_argument, nullptr, 'f'},
+        {"output", required_argument, nullptr, 'o'},
+        {"threads", required_argument, nullptr, 't'},
+        {"depth", required_argument, nullptr, 'd'},
+        {"compression", required_argument, nullptr, 'c'},
+        {"basket-size", required_argument, nullptr, 'b'},
+        {"passes", required_argument, nullptr, 'P'},
+        {"cache-size", required_argument, nullptr, 'C'},
+        {"hugepages", required_argument, nullptr, 'H'},
+        {"kernel", required_argument, nullptr, 'k'},
+        {"cut", required_argument, nullptr, 'x'},
+        {"bins", required_argument, nullptr, 'B'},
+        {"selectivity", required_argument, nullptr, 'S'},
+        {"page-cache", required_argument, nullptr, 'K'},
+        {"direct-io", no_argument, nullptr, 'D'},
+        {"phases", no_argument, nullptr, 'p'},
+        {"counters", no_argument, nullptr, 'e'},
+        {"allocations", no_argument, nullptr, 'a'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "m:w:r:f:o:t:d:c:b:P:C:H:k:x:B:S:K:Dpeah", long_options, nullptr)) != -1) {
+        switch (opt) {
+        case 'm': {
+            std::stringstream ss(optarg);
+            std::string name;
+            while (std::getline(ss, name, ',')) {
+                const BenchmarkMode *mode = FindReadMode(name);
+                if (!mode) {mode = FindWriteMode(name);}
+                if (!mode) {
+                    fprintf(stderr, "Unknown mode: %s\n", name.c_str());
+                    Usage(argv[0]);
+                    return 1;
+                }
+                modes.push_back(mode);
+            }
+            break;
+        }
+        case 'w':
+            if (!ParseCount(optarg, "warmup count", warmup)) {return 1;}
+            break;
+        case 'r':
+            if (!ParseCount(optarg, "repetition count", repetitions)) {return 1;}
+            if (!repetitions) {
+                fprintf(stderr, "At least one repetition is required.\n");
+                return 1;
+            }
+            break;
+        case 'f':
+            if (!ParseResultFormat(optarg, format)) {
+                fprintf(stderr, "Output format must be 'text', 'json', or 'csv'\n");
+                return 1;
+            }
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        case 't': {
+            std::stringstream ss(optarg);
+            std::string count;
+            while (std::getline(ss, count, ',')) {
+                Long64_t threads;
+                if (!ParseCount(count.c_str(), "thread count", threads)) {return 1;}
+                if (!threads) {
+                    fprintf(stderr, "Thread counts must be at least 1.\n");
+                    return 1;
+                }
+                thread_counts.push_back(threads);
+            }
+            break;
+        }
+        case 'd': {
+            Long64_t depth;
+            if (!ParseCount(optarg, "prefetch depth", depth)) {return 1;}
+            if (!depth) {
+                fprintf(stderr, "Prefetch depth must be at least 1.\n");
+                return 1;
+            }
+            options.prefetch_depth = depth;
+            break;
+        }
+        case 'c': {
+            Long64_t compression;
+            if (!ParseCount(optarg, "compression settings", compression)) {return 1;}
+            options.compression = compression;
+            break;
+        }
+        case 'b': {
+            Long64_t basket_size;
+            if (!ParseCount(optarg, "basket size", basket_size)) {return 1;}
+            options.basket_size = basket_size;
+            break;
+        }
+        case 'P': {
+            Long64_t passes;
+            if (!ParseCount(optarg, "pass count", passes)) {return 1;}
+            if (!passes) {
+                fprintf(stderr, "At least one pass is required.\n");
+                return 1;
+            }
+            options.passes = passes;
+            break;
+        }
+        case 'C': {
+            Long64_t cache_mb;
+            if (!ParseCount(optarg, "cache size", cache_mb)) {return 1;}
+            options.cache_bytes = cache_mb * 1024 * 1024;
+            break;
+        }
+        case 'H':
+            if (!ParseHugePages(optarg, options.hugepages)) {
+                fprintf(stderr, "Huge page mode must be 'none', 'thp', or 'explicit'\n");
+                return 1;
+            }
+            break;
+        case 'k':
+            if (!ParseAnalysisKernel(optarg, options.kernel)) {
+                fprintf(stderr, "Kernel must be 'sum', 'minmax', 'moments', 'cut', 'histogram', or 'all'\n");
+                return 1;
+            }
+            break;
+        case 'x':
+            try {
+                options.cut = std::stod(optarg);
+            } catch (...) {
+                fprintf(stderr, "Failed to parse cut (%s) to a number.\n", optarg);
+                return 1;
+            }
+            break;
+        case 'B': {
+            Long64_t bins;
+            if (!ParseCount(optarg, "bin count", bins)) {return 1;}
+            if (!bins) {
+                fprintf(stderr, "The histogram needs at least one bin.\n");
+                return 1;
+            }
+            options.bins = bins;
+            break;
+        }
+        case 'S': {
+            double selectivity = 0;
+            try {
+                selectivity = std::stod(optarg);
+            } catch (...) {}
+            if ((selectivity <= 0) || (selectivity > 1)) {
+                fprintf(stderr, "Selectivity must be in (0, 1] (got %s).\n", optarg);
+                return 1;
+            }
+            options.selectivity = selectivity;
+            break;
+        }
+        case 'K': {
+            std::stringstream ss(optarg);
+            std::string name;
+            while (std::getline(ss, name, ',')) {
+                PageCache state;
+                if (!ParsePageCache(name.c_str(), state)) {
+                    fprintf(stderr, "Page cache state must be 'asis', 'cold', or 'warm'\n");
+                    return 1;
+                }
+                page_caches.push_back(state);
+            }
+            break;
+        }
+        case 'D':
+            options.direct_io = true;
+            break;
+        case 'p':
+            options.phases = true;
+            break;
+        case 'e':
+            options.counters = true;
+            break;
+        case 'a':
+            options.allocations = true;
+            break;
+        case 'h':
+            Usage(argv[0]);
+            return 0;
+        default:
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+    if (argc - optind != 2) {
+        Usage(argv[0]);
+        return 1;
+    }
+    if (!ParseCount(argv[optind], "event count", options.events)) {return 1;}
+    const char *fname = argv[optind + 1];
+    options.fname = fname;
+    if (modes.empty()) {
+        for (const auto &mode : GetReadModes()) {
+            if (mode.default_run) {modes.push_back(&mode);}
+        }
+    }
+    if (thread_counts.empty()) {thread_counts.push_back(1);}
+    // Rows are only labelled with their page cache state when one was asked for.
+    bool label_page_cache = !page_caches.empty();
+    if (page_caches.empty()) {page_caches.push_back(PageCache::kAsIs);}
+    // End arg parsing.
+
+    std::vector<BenchmarkResult> results;
+    for (const BenchmarkMode *mode : modes) {
+        // Write modes create the file, so its page cache state means nothing to them.
+        for (PageCache state : mode->writes ? std::vector<PageCache>{PageCache::kAsIs} : page_caches) {
+            BenchmarkContext cell(options);
+            cell.page_cache = state;
+            std::string suffix = (label_page_cache && !mode->writes) ? std::string("/") + GetPageCacheName(state) : "";
+            if (!mode->threaded) {
+                BenchmarkResult result;
+                if (!RunMode(*mode, cell, 1, warmup, repetitions, result)) {return 1;}
+                result.mode += suffix;
+                results.push_back(result);
+                continue;
+            }
+            // Threaded modes produce a scaling curve relative to the first thread count given.
+            double base_median = 0;
+            int base_threads = thread_counts.front();
+            for (int threads : thread_counts) {
+                BenchmarkResult result;
+                if (!RunMode(*mode, cell, threads, warmup, repetitions, result)) {return 1;}
+                double median = result.Median();
+                if (threads == base_threads) {base_median = median;}
+                double speedup = (median > 0) ? base_median / median : 0;
+                result.mode += suffix;
+                result.metrics.emplace_back("speedup", speedup);
+                result.metrics.emplace_back("efficiency", speedup * base_threads / threads);
+                results.push_back(result);
+            }
+        }
+    }
+
+    FILE *fp = stdout;
+    if (output) {
+        fp = fopen(output, "w");
+        if (!fp) {
+            fprintf(stderr, "Failed to open output file %s: %s\n", output, strerror(errno));
+            return 1;
+        }
+    }
+    WriteResults(fp, format, fname, results);
+    if (fp != stdout) {fclose(fp);}
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+#ifndef BULKAPI_BULK_TREE_WRITER_H
+#define BULKAPI_BULK_TREE_WRITER_H
+
+#include <algorithm>
+#include <string>
+
+#include "Rtypes.h"
+#include "TBasket.h"
+#include "TBranch.h"
+#include "TBuffer.h"
+#include "TTree.h"
+
+/**
+ * TTree::Fill's auto-flush and cluster bookkeeping for trees filled column
+ * by column.
+ *
+ * Ask GetRoom() how many entries to fill into every column next, then call
+ * Advance() once they are all filled.  At each auto-flush boundary it
+ * flushes every basket and records the cluster.  With a byte-sized
+ * auto-flush (ROOT's default), the first cluster ends once the compressed
+ * bytes reach the budget, as in TTree::Fill but checked only once per
+ * step, and later clusters have the same number of entries.  Finish()
+ * sets the tree's entry count.
+ */
+class BulkClusterTracker {
+public:
+    explicit BulkClusterTracker(TTree *tree) : fTree(tree), fAutoFlush(tree->GetAutoFlush()) {}
+
+    /// Entries to fill into every column before the next Advance(), at most `max`.
+    Long64_t GetRoom(Long64_t max) const {
+        return (fAutoFlush > 0) ? std::min(max, fAutoFlush - fInCluster) : max;
+    }
+
+    /// Every column holds `entries` more entries.  Returns false on error.
+    bool Advance(Long64_t entries) {
+        fInCluster += entries;
+        if (fAutoFlush < 0 && fTree->GetZipBytes() >= -fAutoFlush) {
+            // The byte budget fixes the cluster size from here on, as TTree::Fill does.
+            fAutoFlush = fInCluster;
+            fTree->SetAutoFlush(fAutoFlush);
+        }
+        if ((fAutoFlush <= 0) || (fInCluster < fAutoFlush)) {return true;}
+        fInCluster = 0;
+        // FlushBaskets records the cluster boundary at the tree's entry count.
+        fTree->SetEntries(-1);
+        return fTree->FlushBaskets(true) >= 0;
+    }
+
+    /// Set the tree's entry count once every column is complete.
+    void Finish() {fTree->SetEntries(-1);}
+
+private:
+    TTree *fTree;
+    Long64_t fAutoFlush;
+    Long64_t fInCluster{0};
+};
+
+/**
+ * Per-branch writer for a single leaf-list branch of a fundamental type.
+ *
+ * Fill() serializes each run of values straight into the branch's current
+ * basket with one WriteFastArray call and updates the basket's and branch's
+ * entry counts itself, flushing the basket where TBranch::Fill would.  Only
+ * the first value of every basket goes through TBranch::Fill, which creates
+ * or resets the basket.  Fill every column in steps given by a
+ * BulkClusterTracker to get the cluster layout TTree::Fill would have
+ * written.
+ */
+template<typename T>
+class BulkColumnWriter {
+public:
+    BulkColumnWriter(TTree *tree, const char *name, Int_t bufsize) {
+        std::string leaflist = std::string(name) + "/" + LeafType();
+        fBranch = tree->Branch(name, &fValue, leaflist.c_str(), bufsize);
+        fBranch->SetAutoDelete(kFALSE);
+    }
+
+    // The branch keeps the address of fValue.
+    BulkColumnWriter(const BulkColumnWriter&) = delete;
+    BulkColumnWriter &operator=(const BulkColumnWriter&) = delete;
+
+    /// Append `count` values; returns the number of bytes handed to the baskets, or -1 on error.
+    Long64_t Fill(const T *values, Long64_t count) {
+        const Int_t size = sizeof(T);
+        Int_t basket_size = fBranch->GetBasketSize();
+        Long64_t bytes = 0;
+        while (count > 0) {
+            TBasket *basket = fBranch->GetBasket(fBranch->GetWriteBasket());
+            if (!basket || !basket->GetNevBuf()) {
+                // TBranch::Fill creates the write basket and puts it in write mode.
+                fValue = *values++;
+                count--;
+                Int_t nbytes = fBranch->Fill();
+                if (R__unlikely(nbytes < 0)) {return -1;}
+                bytes += nbytes;
+                continue;
+            }
+            TBuffer *buf = basket->GetBufferRef();
+            Int_t offset = buf->Length();
+            // TBranch::Fill flushes the basket once it has no room for another value.
+            Long64_t room = std::max<Long64_t>((basket_size - offset + size - 1) / size - 1, 1);
+            Int_t n = std::min(count, room);
+            for (Int_t idx = 0; idx < n; idx++) {basket->Update(offset + idx * size);}
+            buf->WriteFastArray(values, n);
+            fBranch->SetEntries(fBranch->GetEntries() + n);
+            values += n;
+            count -= n;
+            bytes += static_cast<Long64_t>(n) * size;
+            if ((buf->Length() + size >= basket_size) &&
+                (fBranch->FlushOneBasket(fBranch->GetWriteBasket()) < 0)) {return -1;}
+        }
+        return bytes;
+    }
+
+    TBranch *GetBranch() const {return fBranch;}
+
+private:
+    static const char *LeafType();
+
+    TBranch *fBranch{nullptr};
+    T fValue{};
+};
+
+template<> inline const char *BulkColumnWriter<Float_t>::LeafType() {return "F";}
+template<> inline const char *BulkColumnWriter<Double_t>::LeafType() {return "D";}
+template<> inline const char *BulkColumnWriter<Int_t>::LeafType() {return "I";}
+template<> inline const char *BulkColumnWriter<Long64_t>::LeafType() {return "L";}
+
+#endif  // BULKAPI_BULK_TREE_WRITER_H
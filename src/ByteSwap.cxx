@@ -0,0 +1,244 @@
+
+#include <stdint.h>
+#include <string.h>
+
+#include <initializer_list>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BULKAPI_X86_KERNELS 1
+#endif
+
+#include "ByteSwap.h"
+
+// Scalar fallbacks; also used for the tail of every vector kernel.  Each
+// element is loaded before its slot is written, so in-place decode is safe.
+
+static void Decode32Scalar(const void *src, void *dst, size_t count) {
+    const char *in = static_cast<const char*>(src);
+    char *out = static_cast<char*>(dst);
+    for (size_t idx = 0; idx < count; idx++) {
+        uint32_t value;
+        memcpy(&value, in + 4*idx, 4);
+        value = __builtin_bswap32(value);
+        memcpy(out + 4*idx, &value, 4);
+    }
+}
+
+static void Decode64Scalar(const void *src, void *dst, size_t count) {
+    const char *in = static_cast<const char*>(src);
+    char *out = static_cast<char*>(dst);
+    for (size_t idx = 0; idx < count; idx++) {
+        uint64_t value;
+        memcpy(&value, in + 8*idx, 8);
+        value = __builtin_bswap64(value);
+        memcpy(out + 8*idx, &value, 8);
+    }
+}
+
+#ifdef BULKAPI_X86_KERNELS
+
+__attribute__((target("ssse3")))
+static void Decode32SSSE3(const void *src, void *dst, size_t count) {
+    const __m128i mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const char *in = static_cast<const char*>(src);
+    char *out = static_cast<char*>(dst);
+    size_t idx = 0;
+    for (; idx + 4 <= count; idx += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 4*idx));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4*idx), _mm_shuffle_epi8(v, mask));
+    }
+    Decode32Scalar(in + 4*idx, out + 4*idx, count - idx);
+}
+
+__attribute__((target("ssse3")))
+static void Decode64SSSE3(const void *src, void *dst, size_t count) {
+    const __m128i mask = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    const char *in = static_cast<const char*>(src);
+    char *out = static_cast<char*>(dst);
+    size_t idx = 0;
+    for (; idx + 2 <= count; idx += 2) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 8*idx));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8*idx), _mm_shuffle_epi8(v, mask));
+    }
+    Decode64Scalar(in + 8*idx, out + 8*idx, count - idx);
+}
+
+// vpshufb shuffles within each 128-bit lane, so the wider masks repeat the SSE pattern.
+
+__attribute__((target("avx2")))
+static void Decode32AVX2(const void *src, void *dst, size_t count) {
+    const __m256i mask = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                          3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const char *in = static_cast<const char*>(src);
+    char *out = static_cast<char*>(dst);
+    size_t idx = 0;
+    // Two vectors per iteration keeps both load ports busy.
+    for (; idx + 16 <= count; idx += 16) {
+        __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 4*idx));
+        __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 4*idx + 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 4*idx), _mm256_shuffle_epi8(v0, mask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 4*idx + 32), _mm256_shuffle_epi8(v1, mask));
+    }
+    for (; idx + 8 <= count; idx += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 4*idx));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 4*idx), _mm256_shuffle_epi8(v, mask));
+    }
+    Decode32Scalar(in + 4*idx, out + 4*idx, count - idx);
+}
+
+__attribute__((target("avx2")))
+static void Decode64AVX2(const void *src, void *dst, size_t count) {
+    const __m256i mask = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                                          7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    const char *in = static_cast<const char*>(src);
+    char *out = static_cast<char*>(dst);
+    size_t idx = 0;
+    for (; idx + 8 <= count; idx += 8) {
+        __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 8*idx));
+        __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 8*idx + 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 8*idx), _mm256_shuffle_epi8(v0, mask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 8*idx + 32), _mm256_shuffle_epi8(v1, mask));
+    }
+    for (; idx + 4 <= count; idx += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 8*idx));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 8*idx), _mm256_shuffle_epi8(v, mask));
+    }
+    Decode64Scalar(in + 8*idx, out + 8*idx, count - idx);
+}
+
+static const char kSwap32Mask512[64] = {
+    3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+    3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+    3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+    3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
+static const char kSwap64Mask512[64] = {
+    7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+    7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+    7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+    7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8};
+
+__attribute__((target("avx512f,avx512bw")))
+static void Decode32AVX512(const void *src, void *dst, size_t count) {
+    const __m512i mask = _mm512_loadu_si512(kSwap32Mask512);
+    const char *in = static_cast<const char*>(src);
+    char *out = static_cast<char*>(dst);
+    size_t idx = 0;
+    for (; idx + 16 <= count; idx += 16) {
+        __m512i v = _mm512_loadu_si512(in + 4*idx);
+        _mm512_storeu_si512(out + 4*idx, _mm512_shuffle_epi8(v, mask));
+    }
+    // A masked load/store finishes the tail without dropping back to scalar code.
+    if (idx < count) {
+        __mmask16 tail = (1u << (count - idx)) - 1;
+        __m512i v = _mm512_maskz_loadu_epi32(tail, in + 4*idx);
+        _mm512_mask_storeu_epi32(out + 4*idx, tail, _mm512_shuffle_epi8(v, mask));
+    }
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void Decode64AVX512(const void *src, void *dst, size_t count) {
+    const __m512i mask = _mm512_loadu_si512(kSwap64Mask512);
+    const char *in = static_cast<const char*>(src);
+    char *out = static_cast<char*>(dst);
+    size_t idx = 0;
+    for (; idx + 8 <= count; idx += 8) {
+        __m512i v = _mm512_loadu_si512(in + 8*idx);
+        _mm512_storeu_si512(out + 8*idx, _mm512_shuffle_epi8(v, mask));
+    }
+    if (idx < count) {
+        __mmask8 tail = (1u << (count - idx)) - 1;
+        __m512i v = _mm512_maskz_loadu_epi64(tail, in + 8*idx);
+        _mm512_mask_storeu_epi64(out + 8*idx, tail, _mm512_shuffle_epi8(v, mask));
+    }
+}
+
+#endif  // BULKAPI_X86_KERNELS
+
+typedef void (*DecodeFunction)(const void *src, void *dst, size_t count);
+
+namespace {
+
+struct SwapDispatch {
+    SwapKernel kernel;
+    DecodeFunction decode32;
+    DecodeFunction decode64;
+};
+
+SwapDispatch MakeDispatch(SwapKernel kernel) {
+    switch (kernel) {
+#ifdef BULKAPI_X86_KERNELS
+    case SwapKernel::kSSSE3:
+        return {kernel, Decode32SSSE3, Decode64SSSE3};
+    case SwapKernel::kAVX2:
+        return {kernel, Decode32AVX2, Decode64AVX2};
+    case SwapKernel::kAVX512:
+        return {kernel, Decode32AVX512, Decode64AVX512};
+#endif
+    default:
+        return {SwapKernel::kScalar, Decode32Scalar, Decode64Scalar};
+    }
+}
+
+SwapKernel DetectBestKernel() {
+    for (auto kernel : {SwapKernel::kAVX512, SwapKernel::kAVX2, SwapKernel::kSSSE3}) {
+        if (SwapKernelSupported(kernel)) {return kernel;}
+    }
+    return SwapKernel::kScalar;
+}
+
+SwapDispatch &GetDispatch() {
+    static SwapDispatch dispatch = MakeDispatch(DetectBestKernel());
+    return dispatch;
+}
+
+}  // namespace
+
+bool SwapKernelSupported(SwapKernel kernel) {
+    switch (kernel) {
+    case SwapKernel::kScalar:
+        return true;
+#ifdef BULKAPI_X86_KERNELS
+    case SwapKernel::kSSSE3:
+        return __builtin_cpu_supports("ssse3");
+    case SwapKernel::kAVX2:
+        return __builtin_cpu_supports("avx2");
+    case SwapKernel::kAVX512:
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+    default:
+        return false;
+    }
+}
+
+const char *GetSwapKernelName(SwapKernel kernel) {
+    switch (kernel) {
+    case SwapKernel::kScalar:
+        return "scalar";
+    case SwapKernel::kSSSE3:
+        return "ssse3";
+    case SwapKernel::kAVX2:
+        return "avx2";
+    case SwapKernel::kAVX512:
+        return "avx512";
+    }
+    return "unknown";
+}
+
+SwapKernel GetSwapKernel() {
+    return GetDispatch().kernel;
+}
+
+bool SetSwapKernel(SwapKernel kernel) {
+    if (!SwapKernelSupported(kernel)) {return false;}
+    GetDispatch() = MakeDispatch(kernel);
+    return true;
+}
+
+void DecodeBigEndian32(const void *src, void *dst, size_t count) {
+    GetDispatch().decode32(src, dst, count);
+}
+
+void DecodeBigEndian64(const void *src, void *dst, size_t count) {
+    GetDispatch().decode64(src, dst, count);
+}
@@ -0,0 +1,46 @@
+#ifndef BULKAPI_BYTE_SWAP_H
+#define BULKAPI_BYTE_SWAP_H
+
+#include <stddef.h>
+
+#include "Rtypes.h"
+
+/**
+ * Big-endian to native decoders for the payload returned by
+ * TBulkBranchRead::GetEntriesSerialized.
+ *
+ * The implementation is picked at runtime from the best instruction set the
+ * CPU supports; ByteSwap.cxx is built for baseline x86-64 rather than the
+ * tree's -march=native, so kScalar really is scalar.  Buffers need no
+ * particular alignment; src and dst may be the same pointer (in-place
+ * decode) but must not otherwise overlap.
+ */
+
+enum class SwapKernel {
+    kScalar,
+    kSSSE3,
+    kAVX2,
+    kAVX512
+};
+
+/// The kernel the decoders currently dispatch to.
+SwapKernel GetSwapKernel();
+
+/// Force a specific kernel; returns false (and changes nothing) if the CPU lacks it.
+bool SetSwapKernel(SwapKernel kernel);
+
+bool SwapKernelSupported(SwapKernel kernel);
+const char *GetSwapKernelName(SwapKernel kernel);
+
+void DecodeBigEndian32(const void *src, void *dst, size_t count);
+void DecodeBigEndian64(const void *src, void *dst, size_t count);
+
+inline void DecodeBigEndian(const void *src, float *dst, size_t count) {DecodeBigEndian32(src, dst, count);}
+inline void DecodeBigEndian(const void *src, Int_t *dst, size_t count) {DecodeBigEndian32(src, dst, count);}
+inline void DecodeBigEndian(const void *src, double *dst, size_t count) {DecodeBigEndian64(src, dst, count);}
+inline void DecodeBigEndian(const void *src, Long64_t *dst, size_t count) {DecodeBigEndian64(src, dst, count);}
+
+template<typename T>
+inline void DecodeBigEndianInPlace(T *buf, size_t count) {DecodeBigEndian(buf, buf, count);}
+
+#endif  // BULKAPI_BYTE_SWAP_H
@@ -0,0 +1,110 @@
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "TStopwatch.h"
+
+#include "ByteSwap.h"
+
+// The loop the bulkinline modes used before the vector kernels existed.
+static void ReferenceLoop32(void *buf, size_t count) {
+    Int_t *entry = static_cast<Int_t*>(buf);
+    for (size_t idx = 0; idx < count; idx++) {
+        entry[idx] = __builtin_bswap32(entry[idx]);
+    }
+}
+
+static void ReferenceLoop64(void *buf, size_t count) {
+    Long64_t *entry = static_cast<Long64_t*>(buf);
+    for (size_t idx = 0; idx < count; idx++) {
+        entry[idx] = __builtin_bswap64(entry[idx]);
+    }
+}
+
+static void Report(const char *name, size_t width, bool in_place, size_t bytes, Long64_t iterations, double seconds) {
+    printf("%-10s %2zu-bit %-12s %10.3f GB/s\n", name, 8*width, in_place ? "in-place" : "out-of-place",
+           seconds > 0 ? bytes * iterations / seconds / 1e9 : 0);
+}
+
+/**
+ * Time every available kernel over the same buffer.  The buffer is swapped an
+ * even number of times for in-place runs, so it ends where it started and the
+ * output can be checked against the reference.
+ */
+static bool RunWidth(size_t width, size_t count, Long64_t iterations) {
+    size_t bytes = width * count;
+    std::vector<char> original(bytes), work(bytes), out(bytes), expected(bytes);
+    for (size_t idx = 0; idx < bytes; idx++) {original[idx] = static_cast<char>(idx * 7 + 3);}
+    memcpy(expected.data(), original.data(), bytes);
+    if (width == 4) {ReferenceLoop32(expected.data(), count);} else {ReferenceLoop64(expected.data(), count);}
+
+    TStopwatch sw;
+    memcpy(work.data(), original.data(), bytes);
+    sw.Start();
+    for (Long64_t iter = 0; iter < iterations; iter++) {
+        if (width == 4) {ReferenceLoop32(work.data(), count);} else {ReferenceLoop64(work.data(), count);}
+    }
+    sw.Stop();
+    Report("loop", width, true, bytes, iterations, sw.RealTime());
+
+    for (auto kernel : {SwapKernel::kScalar, SwapKernel::kSSSE3, SwapKernel::kAVX2, SwapKernel::kAVX512}) {
+        if (!SetSwapKernel(kernel)) {continue;}
+        auto decode = (width == 4) ? DecodeBigEndian32 : DecodeBigEndian64;
+
+        memcpy(work.data(), original.data(), bytes);
+        sw.Start();
+        for (Long64_t iter = 0; iter < 2*iterations; iter++) {
+            decode(work.data(), work.data(), count);
+        }
+        sw.Stop();
+        if (memcmp(work.data(), original.data(), bytes)) {
+            printf("In-place %s kernel produced incorrect output.\n", GetSwapKernelName(kernel));
+            return false;
+        }
+        Report(GetSwapKernelName(kernel), width, true, bytes, 2*iterations, sw.RealTime());
+
+        sw.Start();
+        for (Long64_t iter = 0; iter < iterations; iter++) {
+            decode(original.data(), out.data(), count);
+        }
+        sw.Stop();
+        if (memcmp(out.data(), expected.data(), bytes)) {
+            printf("Out-of-place %s kernel produced incorrect output.\n", GetSwapKernelName(kernel));
+            return false;
+        }
+        Report(GetSwapKernelName(kernel), width, false, bytes, iterations, sw.RealTime());
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+
+    if (argc > 3) {
+        fprintf(stderr, "Usage: %s [elements [iterations]]\n", argv[0]);
+        return 1;
+    }
+    // Default to one 32 KiB basket worth of floats, which stays in L1/L2.
+    Long64_t elements = 8*1024, iterations = 100000;
+    try {
+        if (argc > 1) {elements = std::stoll(argv[1]);}
+        if (argc > 2) {iterations = std::stoll(argv[2]);}
+    } catch (...) {
+        fprintf(stderr, "Failed to parse arguments to integers.\n");
+        return 1;
+    }
+    if (elements <= 0 || iterations <= 0) {
+        fprintf(stderr, "Element and iteration counts must be positive.\n");
+        return 1;
+    }
+
+    SwapKernel best = GetSwapKernel();
+    printf("Decoding %lld elements %lld times; runtime-selected kernel is %s.\n",
+           elements, iterations, GetSwapKernelName(best));
+    bool ok = RunWidth(4, elements, iterations) && RunWidth(8, elements, iterations);
+    SetSwapKernel(best);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,307 @@
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "TBranch.h"
+#include "TBufferFile.h"
+#include "TFile.h"
+#include "TLeaf.h"
+#include "TObjArray.h"
+#include "TStopwatch.h"
+#include "TTree.h"
+#include "ROOT/TBulkBranchRead.hxx"
+
+#include "BasketUtils.h"
+#include "ByteSwap.h"
+#include "ColumnarFile.h"
+#include "JaggedBulkReader.h"
+
+/**
+ * Converts branches of tree 'T' into a flat columnar file (see
+ * ColumnarFile.h) that the 'flat' read mode maps directly, as a reference
+ * for how fast the read modes could go without ROOT's serialization.
+ *
+ * Fixed-size branches become one native array each; variable-length array
+ * members such as myStruct.a become a values array plus an offsets array.
+ */
+
+struct ColumnSpec {
+    std::string name;
+    char type;
+    bool jagged;
+};
+
+// Used when no --columns are given: whichever of these the input tree has.
+static const ColumnSpec kDefaultColumns[] = {
+    {"myFloat", 'F', false},
+    {"myDouble", 'D', false},
+    {"myStruct.a", 'F', true},
+    {"myStruct.c", 'D', true},
+};
+
+static void Usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [options] input.root [output.col]\n", prog);
+    fprintf(stderr, "The output defaults to the input name with '.root' replaced by '.col'.\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -c, --columns LIST      Comma-separated name:type pairs; type is F, D, I or L,\n");
+    fprintf(stderr, "                          with a '[]' suffix for variable-length arrays, e.g.\n");
+    fprintf(stderr, "                          myFloat:F,myStruct.a:F[] (default: any of myFloat, myDouble,\n");
+    fprintf(stderr, "                          myStruct.a and myStruct.c present in the tree).\n");
+}
+
+static bool ParseColumnSpec(const std::string &item, ColumnSpec &spec) {
+    size_t colon = item.rfind(':');
+    if ((colon == std::string::npos) || !colon) {return false;}
+    std::string type = item.substr(colon + 1);
+    spec.name = item.substr(0, colon);
+    spec.jagged = (type.size() == 3) && !type.compare(1, 2, "[]");
+    if ((type.size() != 1) && !spec.jagged) {return false;}
+    spec.type = type[0];
+    return strchr("FDIL", spec.type) != nullptr;
+}
+
+static const char *GetColumnTypeName(char type) {
+    switch (type) {
+    case 'F': return "Float_t";
+    case 'D': return "Double_t";
+    case 'I': return "Int_t";
+    case 'L': return "Long64_t";
+    }
+    return "";
+}
+
+/**
+ * Check a column against the branch it is read from: the export decodes the
+ * baskets as the spec's type, so a mismatch would read past the buffer or
+ * write garbage.  The branch must have a single leaf of that type, with a
+ * count leaf exactly when the spec is jagged.
+ */
+static bool CheckColumnSpec(TBranch *branch, const ColumnSpec &spec) {
+    TObjArray *leaves = branch->GetListOfLeaves();
+    TLeaf *leaf = (leaves && (leaves->GetEntriesFast() == 1)) ? static_cast<TLeaf*>(leaves->At(0)) : nullptr;
+    if (!leaf) {
+        printf("Branch '%s' must have exactly one leaf to be exported.\n", spec.name.c_str());
+        return false;
+    }
+    const char *type = leaf->GetTypeName();
+    if (!type || strcmp(type, GetColumnTypeName(spec.type))) {
+        printf("Branch '%s' holds %s, not the %s of its column type '%c'.\n", spec.name.c_str(),
+               type ? type : "an unknown type", GetColumnTypeName(spec.type), spec.type);
+        return false;
+    }
+    if (spec.jagged != (leaf->GetLeafCount() != nullptr)) {
+        printf("Branch '%s' is %s, so its column type needs %s '[]' suffix.\n", spec.name.c_str(),
+               spec.jagged ? "not a variable-length array" : "a variable-length array", spec.jagged ? "no" : "a");
+        return false;
+    }
+    if (!spec.jagged && (leaf->GetLenStatic() != 1)) {
+        printf("Branch '%s' holds fixed-size arrays, which cannot be exported.\n", spec.name.c_str());
+        return false;
+    }
+    return true;
+}
+
+static bool PadToAlignment(FILE *fp) {
+    static const char zeros[kColumnarAlignment] = {};
+    off_t pos = ftello(fp);
+    return (pos >= 0) && (fwrite(zeros, 1, AlignColumnar(pos) - pos, fp) == AlignColumnar(pos) - pos);
+}
+
+/// Stream a fixed-size branch basket by basket, decoding each to native order.
+template<typename T>
+static bool ExportFixed(TBranch *branch, Long64_t entries, FILE *fp, ColumnarColumn &column) {
+    TBufferFile buf(TBuffer::kWrite, 32*1024);
+    std::vector<T> native;
+    Long64_t evt_idx = 0;
+    while (evt_idx < entries) {
+        Int_t count = branch->GetBulkRead().GetEntriesSerialized(evt_idx, buf);
+        if (R__unlikely(count <= 0)) {
+            printf("Failed to read %s for index %lld.\n", column.name, evt_idx);
+            return false;
+        }
+        native.resize(count);
+        DecodeBigEndian(buf.GetCurrent(), native.data(), count);
+        if (fwrite(native.data(), sizeof(T), count, fp) != static_cast<size_t>(count)) {return false;}
+        evt_idx += count;
+    }
+    column.value_count = evt_idx;
+    return true;
+}
+
+/**
+ * Stream the values of a variable-length array branch and collect the
+ * global offsets, which are written after all the values.
+ */
+template<typename T>
+static bool ExportJagged(TBranch *branch, Long64_t entries, FILE *fp, ColumnarColumn &column,
+                         std::vector<uint64_t> &offsets) {
+    JaggedBulkReader<T> reader(branch);
+    offsets.assign(1, 0);
+    offsets.reserve(entries + 1);
+    Long64_t evt_idx = 0;
+    while (evt_idx < entries) {
+        Long64_t count = reader.Load(evt_idx);
+        if (R__unlikely(count <= 0)) {
+            printf("Failed to read %s for index %lld.\n", column.name, evt_idx);
+            return false;
+        }
+        const Long64_t *basket_offsets = reader.GetOffsets();
+        uint64_t base = offsets.back();
+        for (Long64_t idx = 1; idx <= count; idx++) {offsets.push_back(base + basket_offsets[idx]);}
+        size_t values = basket_offsets[count];
+        if (fwrite(reader.GetValues(), sizeof(T), values, fp) != values) {return false;}
+        evt_idx += count;
+    }
+    column.value_count = offsets.back();
+    return true;
+}
+
+template<typename T>
+static bool ExportColumn(TBranch *branch, Long64_t entries, FILE *fp, ColumnarColumn &column) {
+    column.value_size = sizeof(T);
+    if (!PadToAlignment(fp)) {return false;}
+    column.values_offset = ftello(fp);
+    if (!column.jagged) {return ExportFixed<T>(branch, entries, fp, column);}
+    std::vector<uint64_t> offsets;
+    if (!ExportJagged<T>(branch, entries, fp, column, offsets)) {return false;}
+    if (!PadToAlignment(fp)) {return false;}
+    column.offsets_offset = ftello(fp);
+    return fwrite(offsets.data(), sizeof(uint64_t), offsets.size(), fp) == offsets.size();
+}
+
+int main(int argc, char *argv[]) {
+
+    // Handle all the argument parsing up front.
+    std::vector<ColumnSpec> specs;
+    bool explicit_columns = false;
+
+    static const struct option long_options[] = {
+        {"columns", required_argument, nullptr, 'c'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "c:h", long_options, nullptr)) != -1) {
+        switch (opt) {
+        case 'c': {
+            std::stringstream ss(optarg);
+            std::string item;
+            while (std::getline(ss, item, ',')) {
+                ColumnSpec spec;
+                if (!ParseColumnSpec(item, spec)) {
+                    fprintf(stderr, "Column specifications look like name:F or name:D[] (got %s).\n", item.c_str());
+                    return 1;
+                }
+                if (spec.name.size() >= sizeof(ColumnarColumn::name)) {
+                    fprintf(stderr, "Column name %s is too long.\n", spec.name.c_str());
+                    return 1;
+                }
+                specs.push_back(spec);
+            }
+            explicit_columns = true;
+            break;
+        }
+        case 'h':
+            Usage(argv[0]);
+            return 0;
+        default:
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+    if ((argc - optind != 1) && (argc - optind != 2)) {
+        Usage(argv[0]);
+        return 1;
+    }
+    const char *input = argv[optind];
+    std::string output = (argc - optind == 2) ? argv[optind + 1] : GetColumnarFileName(input);
+    if (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__) {
+        fprintf(stderr, "Columnar files are written in native order, which must be little-endian.\n");
+        return 1;
+    }
+    // End arg parsing.
+
+    TFile *hfile = TFile::Open(input);
+    if (!hfile || hfile->IsZombie()) {
+        printf("Failed to open %s.\n", input);
+        return 1;
+    }
+    TTree *tree = dynamic_cast<TTree*>(hfile->Get("T"));
+    if (!tree) {
+        printf("Failed to fetch tree named 'T' from input file.\n");
+        return 1;
+    }
+    std::vector<TBranch*> branches;
+    if (!explicit_columns) {
+        for (const auto &spec : kDefaultColumns) {
+            if (tree->GetBranch(spec.name.c_str())) {specs.push_back(spec);}
+        }
+    }
+    for (const auto &spec : specs) {
+        TBranch *branch = tree->GetBranch(spec.name.c_str());
+        if (!branch) {
+            printf("Unable to find branch '%s' in tree 'T'\n", spec.name.c_str());
+            return 1;
+        }
+        if (!CheckColumnSpec(branch, spec)) {return 1;}
+        branches.push_back(branch);
+    }
+    if (specs.empty()) {
+        printf("No columns to export.\n");
+        return 1;
+    }
+
+    FILE *fp = fopen(output.c_str(), "wb");
+    if (!fp) {
+        fprintf(stderr, "Failed to open output file %s: %s\n", output.c_str(), strerror(errno));
+        return 1;
+    }
+    ColumnarHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kColumnarMagic, sizeof(kColumnarMagic));
+    header.version = 1;
+    header.column_count = specs.size();
+    header.entries = tree->GetEntries();
+    std::vector<ColumnarColumn> columns(specs.size());
+    memset(columns.data(), 0, columns.size() * sizeof(ColumnarColumn));
+    // Reserve the header and directory; they are rewritten once the offsets are known.
+    bool ok = (fwrite(&header, sizeof(header), 1, fp) == 1) &&
+              (fwrite(columns.data(), sizeof(ColumnarColumn), columns.size(), fp) == columns.size());
+
+    TStopwatch sw;
+    sw.Start();
+    for (size_t idx = 0; ok && (idx < specs.size()); idx++) {
+        ColumnarColumn &column = columns[idx];
+        strncpy(column.name, specs[idx].name.c_str(), sizeof(column.name) - 1);
+        column.type = specs[idx].type;
+        column.jagged = specs[idx].jagged;
+        switch (column.type) {
+        case 'F': ok = ExportColumn<float>(branches[idx], header.entries, fp, column); break;
+        case 'D': ok = ExportColumn<double>(branches[idx], header.entries, fp, column); break;
+        case 'I': ok = ExportColumn<Int_t>(branches[idx], header.entries, fp, column); break;
+        case 'L': ok = ExportColumn<Long64_t>(branches[idx], header.entries, fp, column); break;
+        }
+        if (ok) {
+            printf("Exported %s: %llu values%s.\n", column.name, static_cast<unsigned long long>(column.value_count),
+                   column.jagged ? " plus offsets" : "");
+        }
+    }
+    ok = ok && PadToAlignment(fp) && !fseeko(fp, 0, SEEK_SET) &&
+         (fwrite(&header, sizeof(header), 1, fp) == 1) &&
+         (fwrite(columns.data(), sizeof(ColumnarColumn), columns.size(), fp) == columns.size());
+    ok = !fclose(fp) && ok;
+    sw.Stop();
+    hfile->Close();
+    if (!ok) {
+        fprintf(stderr, "Failed to write %s.\n", output.c_str());
+        return 1;
+    }
+    printf("Wrote %llu entries to %s.\n", static_cast<unsigned long long>(header.entries), output.c_str());
+    printf("Total elapsed time (seconds) for export: %.2f\n", sw.RealTime());
+    return 0;
+}
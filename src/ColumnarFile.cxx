@@ -0,0 +1,72 @@
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ColumnarFile.h"
+
+ColumnarFile::~ColumnarFile() {
+    if (fMap) {munmap(const_cast<char*>(fMap), fSize);}
+}
+
+bool ColumnarFile::Open(const char *fname) {
+    if (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__) {
+        printf("Columnar files are little-endian and can only be mapped on little-endian hosts.\n");
+        return false;
+    }
+    int fd = open(fname, O_RDONLY);
+    if (fd < 0) {
+        printf("Failed to open columnar file %s.\n", fname);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) || static_cast<size_t>(st.st_size) < sizeof(ColumnarHeader)) {
+        printf("Columnar file %s is too short.\n", fname);
+        close(fd);
+        return false;
+    }
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        printf("Failed to map %s.\n", fname);
+        return false;
+    }
+    fMap = static_cast<const char*>(map);
+    fSize = st.st_size;
+    fHeader = reinterpret_cast<const ColumnarHeader*>(fMap);
+    if (memcmp(fHeader->magic, kColumnarMagic, sizeof(kColumnarMagic)) || fHeader->version != 1) {
+        printf("%s is not a version 1 columnar file.\n", fname);
+        return false;
+    }
+    if (sizeof(ColumnarHeader) + fHeader->column_count * sizeof(ColumnarColumn) > fSize) {
+        printf("Column directory of %s is truncated.\n", fname);
+        return false;
+    }
+    fColumns = reinterpret_cast<const ColumnarColumn*>(fMap + sizeof(ColumnarHeader));
+    for (uint32_t idx = 0; idx < fHeader->column_count; idx++) {
+        const ColumnarColumn &column = fColumns[idx];
+        bool ok = (column.values_offset + column.value_count * column.value_size <= fSize);
+        if (column.jagged) {
+            ok = ok && (column.offsets_offset + (fHeader->entries + 1) * sizeof(uint64_t) <= fSize);
+        } else {
+            ok = ok && (column.value_count == fHeader->entries);
+        }
+        if (!ok) {
+            printf("Column %.64s of %s is truncated or inconsistent.\n", column.name, fname);
+            return false;
+        }
+    }
+    madvise(map, fSize, MADV_SEQUENTIAL);
+    return true;
+}
+
+const ColumnarColumn *ColumnarFile::FindColumn(const char *name) const {
+    if (!fColumns) {return nullptr;}
+    for (uint32_t idx = 0; idx < fHeader->column_count; idx++) {
+        if (!strncmp(fColumns[idx].name, name, sizeof(fColumns[idx].name))) {return &fColumns[idx];}
+    }
+    return nullptr;
+}
@@ -0,0 +1,104 @@
+#ifndef BULKAPI_COLUMNAR_FILE_H
+#define BULKAPI_COLUMNAR_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+/**
+ * A flat columnar file: the "speed of light" reference for the ROOT read
+ * modes.  Everything is little-endian and every region starts on a 64-byte
+ * boundary, so a mapped column can be used in place as a native array.
+ *
+ * Layout:
+ *   ColumnarHeader                    at offset 0
+ *   ColumnarColumn[column_count]      right after the header
+ *   per column: values, then (jagged columns only) entries+1 uint64_t
+ *   offsets so entry i holds values [offsets[i], offsets[i+1]).
+ */
+
+static const char kColumnarMagic[8] = {'B', 'U', 'L', 'K', 'C', 'O', 'L', '1'};
+static const size_t kColumnarAlignment = 64;
+
+struct ColumnarHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t column_count;
+    uint64_t entries;
+    char reserved[40];
+};
+
+struct ColumnarColumn {
+    char name[64];          // NUL-padded branch name.
+    char type;              // 'F', 'D', 'I' or 'L', as in a ROOT leaf list.
+    uint8_t jagged;         // 1 if offsets_offset is valid.
+    uint16_t reserved;
+    uint32_t value_size;    // Bytes per value.
+    uint64_t value_count;   // Total values in the column.
+    uint64_t values_offset; // File offset of the values.
+    uint64_t offsets_offset;
+    char padding[32];
+};
+
+static_assert(sizeof(ColumnarHeader) == 64, "ColumnarHeader must be one cache line");
+static_assert(sizeof(ColumnarColumn) == 128, "ColumnarColumn must be two cache lines");
+
+/// Round `offset` up to the next multiple of kColumnarAlignment.
+inline uint64_t AlignColumnar(uint64_t offset) {
+    return (offset + kColumnarAlignment - 1) & ~static_cast<uint64_t>(kColumnarAlignment - 1);
+}
+
+/**
+ * The columnar file exported next to a ROOT file: 'x.root' becomes 'x.col',
+ * anything else gets '.col' appended.
+ */
+inline std::string GetColumnarFileName(const std::string &root_fname) {
+    const std::string suffix = ".root";
+    if ((root_fname.size() > suffix.size()) &&
+        !root_fname.compare(root_fname.size() - suffix.size(), suffix.size(), suffix)) {
+        return root_fname.substr(0, root_fname.size() - suffix.size()) + ".col";
+    }
+    return root_fname + ".col";
+}
+
+/**
+ * Read-only mapping of a columnar file.  Columns are handed out as pointers
+ * straight into the mapping.
+ */
+class ColumnarFile {
+public:
+    ColumnarFile() = default;
+    ~ColumnarFile();
+    ColumnarFile(const ColumnarFile &) = delete;
+    ColumnarFile &operator=(const ColumnarFile &) = delete;
+
+    /// Map and validate the file; prints why and returns false on failure.
+    bool Open(const char *fname);
+
+    uint64_t GetEntries() const {return fHeader ? fHeader->entries : 0;}
+
+    /// nullptr if there is no such column.
+    const ColumnarColumn *FindColumn(const char *name) const;
+
+    /// The values of a column, or nullptr if its type is not T.
+    template<typename T>
+    const T *GetValues(const ColumnarColumn &column) const {
+        if (column.value_size != sizeof(T)) {return nullptr;}
+        return reinterpret_cast<const T*>(fMap + column.values_offset);
+    }
+
+    /// The offsets of a jagged column, or nullptr for a fixed-size one.
+    const uint64_t *GetOffsets(const ColumnarColumn &column) const {
+        if (!column.jagged) {return nullptr;}
+        return reinterpret_cast<const uint64_t*>(fMap + column.offsets_offset);
+    }
+
+private:
+    const char *fMap{nullptr};
+    size_t fSize{0};
+    const ColumnarHeader *fHeader{nullptr};
+    const ColumnarColumn *fColumns{nullptr};
+};
+
+#endif  // BULKAPI_COLUMNAR_FILE_H
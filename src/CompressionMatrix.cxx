@@ -0,0 +1,325 @@
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BenchmarkContext.h"
+#include "BenchmarkResults.h"
+#include "BenchmarkRunner.h"
+#include "ReadModes.h"
+#include "WriteModes.h"
+
+/**
+ * Writes one file per codec and level, reads each with every requested read
+ * mode, and tabulates the size / speed trade-off.
+ *
+ * Besides the requested modes every file is also read with 'rawio' and
+ * 'unzip', so each row can split its time into I/O, decompression
+ * (unzip - rawio) and deserialization (mode - unzip).  With --page-cache the
+ * whole read side, split included, is repeated for each page cache state.
+ */
+
+struct Codec {
+    const char *name;
+    int algorithm;  // ROOT::ECompressionAlgorithm
+};
+
+static const Codec kCodecs[] = {
+    {"zlib", 1},
+    {"lzma", 2},
+    {"lz4", 4},
+    {"zstd", 5},
+};
+
+static void Usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [options] events prefix\n", prog);
+    fprintf(stderr, "Writes prefix-<codec>-<level>.root for every combination, then reads each file.\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -a, --codecs LIST       Comma-separated codecs: zlib, lzma, lz4, zstd (default: zlib,lzma,lz4).\n");
+    fprintf(stderr, "  -l, --levels LIST       Comma-separated compression levels 1-9 (default: 1,6,9).\n");
+    fprintf(stderr, "                          An uncompressed file is always included.\n");
+    fprintf(stderr, "  -W, --write-mode NAME   Write mode used to create the files (default: fill).\n");
+    fprintf(stderr, "  -m, --modes LIST        Comma-separated read modes (default: standard,bulk,bulkinline).\n");
+    fprintf(stderr, "  -w, --warmup N          Untimed warmup repetitions per read mode (default: 1).\n");
+    fprintf(stderr, "  -r, --repetitions N     Timed repetitions per mode, writes included (default: 3).\n");
+    fprintf(stderr, "  -f, --format FMT        Output format: text, json or csv (default: text).\n");
+    fprintf(stderr, "  -o, --output FILE       Write results to FILE instead of stdout.\n");
+    fprintf(stderr, "  -t, --threads LIST      Comma-separated thread counts for threaded read and write modes (default: 1).\n");
+    fprintf(stderr, "  -b, --basket-size N     Basket size in bytes (default: 320000).\n");
+    fprintf(stderr, "  -K, --page-cache LIST   Comma-separated page cache states for the reads: asis, cold or warm;\n");
+    fprintf(stderr, "                          each gets its own rows, labelled codec/mode/state (default: asis).\n");
+    fprintf(stderr, "  -D, --direct-io         Read with O_DIRECT in rawio and parallelunzip.\n");
+    fprintf(stderr, "  -k, --keep              Keep the generated files (default: delete after reading).\n");
+}
+
+/**
+ * Write one file at the given compression settings and read it with every
+ * mode, appending one result per read mode.  Each result carries the
+ * write-side numbers and the phase split as metrics.
+ */
+static bool RunCell(const char *label, int compression, const BenchmarkMode &write_mode,
+                    const std::vector<const BenchmarkMode*> &read_modes, const std::vector<int> &thread_counts,
+                    const std::vector<PageCache> &page_caches, bool label_page_cache,
+                    const BenchmarkContext &options, Long64_t warmup, Long64_t repetitions,
+                    std::vector<BenchmarkResult> &results) {
+    BenchmarkContext cell(options);
+    cell.compression = compression;
+
+    // A threaded write mode is timed at every thread count, giving a write
+    // scaling curve per codec; the reads use the file from the last one.
+    BenchmarkResult written;
+    for (int threads : write_mode.threaded ? thread_counts : std::vector<int>{1}) {
+        BenchmarkResult result;
+        if (!RunMode(write_mode, cell, threads, 0, repetitions, result)) {return false;}
+        if (write_mode.threaded) {
+            BenchmarkResult row(result);
+            row.mode = std::string(label) + "/" + write_mode.name;
+            row.metrics.emplace_back("compression", compression);
+            results.push_back(row);
+        }
+        written = result;
+    }
+    struct stat st;
+    double file_bytes = stat(cell.fname, &st) ? 0 : st.st_size;
+    double zip_bytes = written.GetMetric("zip_bytes");
+    double ratio = zip_bytes > 0 ? written.GetMetric("tot_bytes") / zip_bytes : 0;
+
+    for (PageCache state : page_caches) {
+        cell.page_cache = state;
+        std::string suffix = label_page_cache ? std::string("/") + GetPageCacheName(state) : "";
+        BenchmarkResult rawio, unzip;
+        if (!RunMode(*FindReadMode("rawio"), cell, 1, warmup, repetitions, rawio)) {return false;}
+        if (!RunMode(*FindReadMode("unzip"), cell, 1, warmup, repetitions, unzip)) {return false;}
+        double io_s = rawio.Median();
+        double unzip_s = unzip.Median();
+
+        for (const BenchmarkMode *mode : read_modes) {
+            // Threaded modes run once per thread count, giving a scaling curve per codec.
+            for (int threads : mode->threaded ? thread_counts : std::vector<int>{1}) {
+                BenchmarkResult result;
+                if (!RunMode(*mode, cell, threads, warmup, repetitions, result)) {return false;}
+                result.mode = std::string(label) + "/" + mode->name + suffix;
+                result.metrics.emplace_back("compression", compression);
+                result.metrics.emplace_back("file_bytes", file_bytes);
+                result.metrics.emplace_back("ratio", ratio);
+                result.metrics.emplace_back("write_MB_s", written.MBPerSecond());
+                result.metrics.emplace_back("io_s", io_s);
+                result.metrics.emplace_back("decompress_s", unzip_s > io_s ? unzip_s - io_s : 0);
+                result.metrics.emplace_back("deserialize_s", result.Median() > unzip_s ? result.Median() - unzip_s : 0);
+                results.push_back(result);
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+
+    // Handle all the argument parsing up front.
+    std::vector<const Codec*> codecs;
+    std::vector<int> levels;
+    const BenchmarkMode *write_mode = FindWriteMode("fill");
+    std::vector<const BenchmarkMode*> read_modes;
+    std::vector<int> thread_counts;
+    std::vector<PageCache> page_caches;
+    Long64_t warmup = 1, repetitions = 3;
+    ResultFormat format = ResultFormat::kText;
+    const char *output = nullptr;
+    bool keep = false;
+    BenchmarkContext options;
+
+    static const struct option long_options[] = {
+        {"codecs", required_argument, nullptr, 'a'},
+        {"levels", required_argument, nullptr, 'l'},
+        {"write-mode", required_argument, nullptr, 'W'},
+        {"modes", required_argument, nullptr, 'm'},
+        {"warmup", required_argument, nullptr, 'w'},
+        {"repetitions", required_argument, nullptr, 'r'},
+        {"format", required_argument, nullptr, 'f'},
+        {"output", required_argument, nullptr, 'o'},
+        {"threads", required_argument, nullptr, 't'},
+        {"basket-size", required_argument, nullptr, 'b'},
+        {"page-cache", required_argument, nullptr, 'K'},
+        {"direct-io", no_argument, nullptr, 'D'},
+        {"keep", no_argument, nullptr, 'k'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "a:l:W:m:w:r:f:o:t:b:K:Dkh", long_options, nullptr)) != -1) {
+        switch (opt) {
+        case 'a': {
+            std::stringstream ss(optarg);
+            std::string name;
+            while (std::getline(ss, name, ',')) {
+                const Codec *codec = nullptr;
+                for (const auto &candidate : kCodecs) {
+                    if (name == candidate.name) {codec = &candidate;}
+                }
+                if (!codec) {
+                    fprintf(stderr, "Unknown codec: %s\n", name.c_str());
+                    return 1;
+                }
+                codecs.push_back(codec);
+            }
+            break;
+        }
+        case 'l': {
+            std::stringstream ss(optarg);
+            std::string level;
+            while (std::getline(ss, level, ',')) {
+                Long64_t value;
+                if (!ParseCount(level.c_str(), "compression level", value)) {return 1;}
+                if ((value < 1) || (value > 9)) {
+                    fprintf(stderr, "Compression levels must be between 1 and 9 (got %s).\n", level.c_str());
+                    return 1;
+                }
+                levels.push_back(value);
+            }
+            break;
+        }
+        case 'W':
+            write_mode = FindWriteMode(optarg);
+            if (!write_mode) {
+                fprintf(stderr, "Unknown write mode: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'm': {
+            std::stringstream ss(optarg);
+            std::string name;
+            while (std::getline(ss, name, ',')) {
+                const BenchmarkMode *mode = FindReadMode(name);
+                if (!mode) {
+                    fprintf(stderr, "Unknown read mode: %s\n", name.c_str());
+                    return 1;
+                }
+                read_modes.push_back(mode);
+            }
+            break;
+        }
+        case 'w':
+            if (!ParseCount(optarg, "warmup count", warmup)) {return 1;}
+            break;
+        case 'r':
+            if (!ParseCount(optarg, "repetition count", repetitions)) {return 1;}
+            if (!repetitions) {
+                fprintf(stderr, "At least one repetition is required.\n");
+                return 1;
+            }
+            break;
+        case 'f':
+            if (!ParseResultFormat(optarg, format)) {
+                fprintf(stderr, "Output format must be 'text', 'json', or 'csv'\n");
+                return 1;
+            }
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        case 't': {
+            std::stringstream ss(optarg);
+            std::string count;
+            while (std::getline(ss, count, ',')) {
+                Long64_t threads;
+                if (!ParseCount(count.c_str(), "thread count", threads)) {return 1;}
+                if (!threads) {
+                    fprintf(stderr, "Thread counts must be at least 1.\n");
+                    return 1;
+                }
+                thread_counts.push_back(threads);
+            }
+            break;
+        }
+        case 'b': {
+            Long64_t basket_size;
+            if (!ParseCount(optarg, "basket size", basket_size)) {return 1;}
+            options.basket_size = basket_size;
+            break;
+        }
+        case 'K': {
+            std::stringstream ss(optarg);
+            std::string name;
+            while (std::getline(ss, name, ',')) {
+                PageCache state;
+                if (!ParsePageCache(name.c_str(), state)) {
+                    fprintf(stderr, "Page cache state must be 'asis', 'cold', or 'warm'\n");
+                    return 1;
+                }
+                page_caches.push_back(state);
+            }
+            break;
+        }
+        case 'D':
+            options.direct_io = true;
+            break;
+        case 'k':
+            keep = true;
+            break;
+        case 'h':
+            Usage(argv[0]);
+            return 0;
+        default:
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+    if (argc - optind != 2) {
+        Usage(argv[0]);
+        return 1;
+    }
+    if (!ParseCount(argv[optind], "event count", options.events)) {return 1;}
+    const char *prefix = argv[optind + 1];
+    if (codecs.empty()) {
+        for (const char *name : {"zlib", "lzma", "lz4"}) {
+            for (const auto &codec : kCodecs) {
+                if (!strcmp(name, codec.name)) {codecs.push_back(&codec);}
+            }
+        }
+    }
+    if (levels.empty()) {levels = {1, 6, 9};}
+    if (thread_counts.empty()) {thread_counts.push_back(1);}
+    bool label_page_cache = !page_caches.empty();
+    if (page_caches.empty()) {page_caches.push_back(PageCache::kAsIs);}
+    if (read_modes.empty()) {
+        for (const char *name : {"standard", "bulk", "bulkinline"}) {read_modes.push_back(FindReadMode(name));}
+    }
+    // End arg parsing.
+
+    // Uncompressed first, then every codec at every level.
+    std::vector<std::pair<std::string, int>> cells = {{"none-0", 0}};
+    for (const Codec *codec : codecs) {
+        for (int level : levels) {
+            cells.emplace_back(std::string(codec->name) + "-" + std::to_string(level), codec->algorithm*100 + level);
+        }
+    }
+
+    std::vector<BenchmarkResult> results;
+    for (const auto &cell : cells) {
+        std::string fname = std::string(prefix) + "-" + cell.first + ".root";
+        options.fname = fname.c_str();
+        bool ok = RunCell(cell.first.c_str(), cell.second, *write_mode, read_modes, thread_counts, page_caches,
+                          label_page_cache, options, warmup, repetitions, results);
+        if (!keep) {unlink(fname.c_str());}
+        if (!ok) {return 1;}
+    }
+
+    FILE *fp = stdout;
+    if (output) {
+        fp = fopen(output, "w");
+        if (!fp) {
+            fprintf(stderr, "Failed to open output file %s: %s\n", output, strerror(errno));
+            return 1;
+        }
+    }
+    WriteResults(fp, format, prefix, results);
+    if (fp != stdout) {fclose(fp);}
+
+    return 0;
+}
@@ -1,6 +1,9 @@
 
 #include <stdio.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "TBranch.h"
 #include "TBufferFile.h"
 #include "TFile.h"
@@ -12,6 +15,10 @@
 #include "ROOT/TTreeReaderValueFast.hxx"
 #include "ROOT/TBulkBranchRead.hxx"
 
+#include "BulkTreeWriter.h"
+#include "ByteSwap.h"
+#include "MultiBranchBulkReader.h"
+
 int main(int argc, char *argv[]) {
 
     TFile *hfile;
@@ -109,6 +116,7 @@ int main(int argc, char *argv[]) {
             Long64_t idx = 0;
             float idx_f = 1;
             double idx_g = 2;
+            sw.Start();
             for (auto it : myReader) {
                 if (R__unlikely(idx == events)) {break;}
                 idx_f++;
@@ -138,6 +146,7 @@ int main(int argc, char *argv[]) {
             }
             float idx_f = 1;
             Long64_t evt_idx = 0;
+            sw.Start();
             while (events) {
                 auto count = branchF->GetBulkRead().GetEntriesSerialized(evt_idx, branchbuf);
                 if (R__unlikely(count < 0)) {
@@ -150,11 +159,9 @@ int main(int argc, char *argv[]) {
                     events = 0;
                 }
                 float *entry = reinterpret_cast<float*>(branchbuf.GetCurrent());
+                DecodeBigEndianInPlace(entry, count);
                 for (Int_t idx=0; idx<count; idx++) {
                     idx_f++;
-                    Int_t *buf = reinterpret_cast<Int_t*>(&entry[idx]);
-                    *buf = __builtin_bswap32(*buf);
-
                     if (R__unlikely((evt_idx < 16000000) && (entry[idx] != idx_f))) {
                     //if (R__unlikely((evt_idx < 16000000) && (entry[idx] == -idx_f))) {
                         printf("Incorrect value on myFloat branch: %f (event %ld)\n", entry[idx], evt_idx + idx);
@@ -165,73 +172,46 @@ int main(int argc, char *argv[]) {
             }
         } else {
             printf("Using bulk read APIs.\n");
-            // Read using bulk APIs.
-            TBufferFile branchbuf(TBuffer::kWrite, 32*1024);
-            TBufferFile branchbuf2(TBuffer::kWrite, 32*1024);
+            // Read using bulk APIs; the reader keeps the two branches' baskets in step.
             TTree *tree = dynamic_cast<TTree*>(hfile->Get("T"));
             if (!tree) {
                 std::cout << "Failed to fetch tree named 'T' from input file.\n";
                 return 1;
             }
-            TBranch *branchF = tree->GetBranch("myFloat");
-            if (!branchF) {
-                std::cout << "Unable to find branch 'myFloat' in tree 'T'\n";
-                return 1;
-            }
-            TBranch *branchG = tree->GetBranch("myDouble");
-            if (!branchG) {
-                std::cout << "Unable to find branch 'myDouble' in tree 'T'\n";
+            MultiBranchBulkReader<float, double> reader(tree, {{"myFloat", "myDouble"}}, events);
+            if (!reader.IsValid()) {
                 return 1;
             }
             sw.Start();
-            float idx_f = 1, idx_g = 2;
-            Long64_t evt_idx = 0, evt2_idx = 0;
-            Int_t count = 0, count2 = 0, idx, idx2;
-            while (events) {
-                //printf("Fetching entries on event %lld.\n", evt_idx);
-                if (count == 0) {
-                    //printf("Fetching entries for myFloat branch.\n");
-                    count = branchF->GetBulkRead().GetEntriesFast(evt_idx, branchbuf);
-                    idx = 0;
-                }
-                if (count2 == 0) {
-                    //printf("Fetching entries for myDouble branch.\n");
-                    count2 = branchG->GetBulkRead().GetEntriesFast(evt_idx, branchbuf2);
-                    idx2 = 0;
-                }
-                if (R__unlikely((count < 0) || (count2 < 0))) {
-                    printf("Failed to get entries via the 'fast' method for index %d.\n", evt_idx);
-                    return 1;
-                }
-                auto count_min = std::min(count, count2);
-                //printf("Will iterate for %d events.\n", count_min);
-                events = (events > count_min) ? (events - count_min) : 0;
-
-                float *entry = reinterpret_cast<float*>(branchbuf.GetCurrent());
-                double *entry2 = reinterpret_cast<double*>(branchbuf2.GetCurrent());
-                for (int loop_idx = 0; loop_idx<count_min; loop_idx++, idx++, idx2++) {
-                    idx_f++;
-                    idx_g++;
-                    if (R__unlikely((evt_idx < 16000000) && (entry[idx] != idx_f))) {
-                        printf("Incorrect value on myFloat branch: %f (expected %f on event %ld)\n", entry[idx], idx_f, evt_idx + idx);
+            Long64_t count;
+            while ((count = reader.Next()) > 0) {
+                Long64_t evt_idx = reader.GetFirstEntry();
+                const float *entry = reader.Get<0>();
+                const double *entry2 = reader.Get<1>();
+                for (Long64_t idx = 0; idx < count; idx++) {
+                    Long64_t evt = evt_idx + idx;
+                    float idx_f = evt + 2;
+                    double idx_g = evt + 3;
+                    if (R__unlikely((evt < 16000000) && (entry[idx] != idx_f))) {
+                        printf("Incorrect value on myFloat branch: %f (expected %f on event %lld)\n", entry[idx], idx_f, evt);
                         return 1;
                     }
-                    if (R__unlikely((evt_idx < 15000000) && (entry2[idx2] != idx_g))) {
-                        printf("Incorrect value on myDouble branch: %f (event %ld)\n", entry2[idx2], evt_idx + idx2);
+                    if (R__unlikely((evt < 15000000) && (entry2[idx] != idx_g))) {
+                        printf("Incorrect value on myDouble branch: %f (expected %f on event %lld)\n", entry2[idx], idx_g, evt);
                         return 1;
                     }
                 }
-                evt_idx += count_min;
-                count -= count_min;
-                count2 -= count_min;
+            }
+            if (count < 0) {
+                return 1;
             }
         }
         sw.Stop();
         printf("Successful read of all events.\n");
-        printf("Total elapsed time (seconds) for bulk APIs: %.2f\n", sw.RealTime());
+        printf("Total elapsed time (seconds) for bulk APIs: %.6f\n", sw.RealTime());
     } else {
-        if (!do_std) {
-            printf("There are currently no bulk APIs for writing.\n");
+        if (do_fast_reader || do_inline) {
+            printf("Writes are only available in 'standard' and 'bulk' modes.\n");
             return 1;
         }
         hfile = new TFile(fname, "RECREATE", "TTree float micro benchmark ROOT file");
@@ -249,21 +229,51 @@ int main(int argc, char *argv[]) {
         }
         // Otherwise, we keep with the current ROOT defaults.
         tree = new TTree("T", "A ROOT tree of floats.");
-        float f = 2;
-        double g = 3;
-        TBranch *branch2 = tree->Branch("myFloat", &f, 320000, 1);
-        TBranch *branch3 = tree->Branch("myDouble", &g, 320000, 1);
-        branch2->SetAutoDelete(kFALSE);
-        branch3->SetAutoDelete(kFALSE);
-        for (Long64_t ev = 0; ev < events; ev++) {
-          tree->Fill();
-          f ++;
-          g ++;
+        TStopwatch sw;
+        if (do_std) {
+            printf("Using standard write APIs.\n");
+            float f = 2;
+            double g = 3;
+            TBranch *branch2 = tree->Branch("myFloat", &f, 320000, 1);
+            TBranch *branch3 = tree->Branch("myDouble", &g, 320000, 1);
+            branch2->SetAutoDelete(kFALSE);
+            branch3->SetAutoDelete(kFALSE);
+            sw.Start();
+            for (Long64_t ev = 0; ev < events; ev++) {
+              tree->Fill();
+              f ++;
+              g ++;
+            }
+        } else {
+            printf("Using bulk write APIs.\n");
+            BulkColumnWriter<float> writerF(tree, "myFloat", 320000);
+            BulkColumnWriter<double> writerG(tree, "myDouble", 320000);
+            std::vector<float> valuesF(std::min<Long64_t>(events, 1024*1024));
+            std::vector<double> valuesG(valuesF.size());
+            float f = 2;
+            double g = 3;
+            BulkClusterTracker clusters(tree);
+            sw.Start();
+            for (Long64_t ev = 0, count; ev < events; ev += count) {
+                count = clusters.GetRoom(std::min<Long64_t>(valuesF.size(), events - ev));
+                for (Long64_t idx = 0; idx < count; idx++) {
+                    valuesF[idx] = f++;
+                    valuesG[idx] = g++;
+                }
+                if ((writerF.Fill(valuesF.data(), count) < 0) || (writerG.Fill(valuesG.data(), count) < 0) ||
+                    !clusters.Advance(count)) {
+                    printf("Failed to write entries via the bulk API at event %lld.\n", ev);
+                    return 1;
+                }
+            }
+            clusters.Finish();
         }
         hfile = tree->GetCurrentFile();
         hfile->Write();
+        sw.Stop();
         tree->Print();
         printf("Successful write of all events.\n");
+        printf("Total elapsed time (seconds) for writes: %.6f\n", sw.RealTime());
     }
     hfile->Close();
 
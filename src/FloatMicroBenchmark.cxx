@@ -1,6 +1,9 @@
 
 #include <stdio.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "TBranch.h"
 #include "TBufferFile.h"
 #include "TFile.h"
@@ -12,6 +15,9 @@
 #include "ROOT/TTreeReaderValueFast.hxx"
 #include "ROOT/TBulkBranchRead.hxx"
 
+#include "BulkTreeWriter.h"
+#include "ByteSwap.h"
+
 int main(int argc, char *argv[]) {
 
     TFile *hfile;
@@ -96,6 +102,7 @@ int main(int argc, char *argv[]) {
             }
             Long64_t idx = 0;
             float idx_f = 1;
+            sw.Start();
             for (auto it : myReader) {
                 if (R__unlikely(idx == events)) {break;}
                 idx_f++;
@@ -120,6 +127,7 @@ int main(int argc, char *argv[]) {
             }
             float idx_f = 1;
             Long64_t evt_idx = 0;
+            sw.Start();
             while (events) {
                 auto count = branchF->GetBulkRead().GetEntriesSerialized(evt_idx, branchbuf);
                 if (R__unlikely(count < 0)) {
@@ -132,11 +140,9 @@ int main(int argc, char *argv[]) {
                     events = 0;
                 }
                 float *entry = reinterpret_cast<float*>(branchbuf.GetCurrent());
+                DecodeBigEndianInPlace(entry, count);
                 for (Int_t idx=0; idx<count; idx++) {
                     idx_f++;
-                    Int_t *buf = reinterpret_cast<Int_t*>(&entry[idx]);
-                    *buf = __builtin_bswap32(*buf);
-
                     if (R__unlikely((evt_idx < 16000000) && (entry[idx] != idx_f))) {
                     //if (R__unlikely((evt_idx < 16000000) && (entry[idx] == -idx_f))) {
                         printf("Incorrect value on myFloat branch: %f (event %ld)\n", entry[idx], evt_idx + idx);
@@ -191,10 +197,10 @@ int main(int argc, char *argv[]) {
         }
         sw.Stop();
         printf("Successful read of all events.\n");
-        printf("Total elapsed time (seconds) for bulk APIs: %.2f\n", sw.RealTime());
+        printf("Total elapsed time (seconds) for bulk APIs: %.6f\n", sw.RealTime());
     } else {
-        if (!do_std) {
-            printf("There are currently no bulk APIs for writing.\n");
+        if (do_fast_reader || do_inline) {
+            printf("Writes are only available in 'standard' and 'bulk' modes.\n");
             return 1;
         }
         hfile = new TFile(fname, "RECREATE", "TTree float micro benchmark ROOT file");
@@ -212,17 +218,40 @@ int main(int argc, char *argv[]) {
         }
         // Otherwise, we keep with the current ROOT defaults.
         tree = new TTree("T", "A ROOT tree of floats.");
-        float f = 2;
-        TBranch *branch2 = tree->Branch("myFloat", &f, 320000, 1);
-        branch2->SetAutoDelete(kFALSE);
-        for (Long64_t ev = 0; ev < events; ev++) {
-          tree->Fill();
-          f ++;
+        TStopwatch sw;
+        if (do_std) {
+            printf("Using standard write APIs.\n");
+            float f = 2;
+            TBranch *branch2 = tree->Branch("myFloat", &f, 320000, 1);
+            branch2->SetAutoDelete(kFALSE);
+            sw.Start();
+            for (Long64_t ev = 0; ev < events; ev++) {
+              tree->Fill();
+              f ++;
+            }
+        } else {
+            printf("Using bulk write APIs.\n");
+            BulkColumnWriter<float> writerF(tree, "myFloat", 320000);
+            std::vector<float> values(std::min<Long64_t>(events, 1024*1024));
+            BulkClusterTracker clusters(tree);
+            float f = 2;
+            sw.Start();
+            for (Long64_t ev = 0, count; ev < events; ev += count) {
+                count = clusters.GetRoom(std::min<Long64_t>(values.size(), events - ev));
+                for (Long64_t idx = 0; idx < count; idx++) {values[idx] = f++;}
+                if ((writerF.Fill(values.data(), count) < 0) || !clusters.Advance(count)) {
+                    printf("Failed to write entries via the bulk API at event %lld.\n", ev);
+                    return 1;
+                }
+            }
+            clusters.Finish();
         }
         hfile = tree->GetCurrentFile();
         hfile->Write();
+        sw.Stop();
         tree->Print();
         printf("Successful write of all events.\n");
+        printf("Total elapsed time (seconds) for writes: %.6f\n", sw.RealTime());
     }
     hfile->Close();
 
@@ -0,0 +1,93 @@
+#ifndef BULKAPI_JAGGED_BULK_READER_H
+#define BULKAPI_JAGGED_BULK_READER_H
+
+#include <algorithm>
+#include <vector>
+
+#include "Rtypes.h"
+#include "TBranch.h"
+#include "TBufferFile.h"
+#include "ROOT/TBulkBranchRead.hxx"
+
+#include "BasketUtils.h"
+#include "ByteSwap.h"
+
+/**
+ * Bulk reader for a variable-length array member such as
+ * VariableLengthStruct::a (`Float_t *a; //[myLen]`).
+ *
+ * Each Load() turns one GetEntriesSerialized call into a native-endian,
+ * contiguous array of every value in the basket plus a prefix-sum offsets
+ * array, so event i of the basket holds values [offsets[i], offsets[i+1]).
+ *
+ * On disk every event starts with a one-byte marker written by the streamer
+ * for pointer members; a zero marker means the pointer was null and no
+ * values follow, so that event is reported as empty whatever its count.
+ */
+template<typename T>
+class JaggedBulkReader {
+public:
+    explicit JaggedBulkReader(TBranch *branch)
+        : fBranch(branch), fBoundaries(GetBasketBoundaries(branch)) {}
+
+    /**
+     * Load the basket containing entry `evt`.  Returns the number of events
+     * in the basket, 0 past the end of the branch and -1 on a read error.
+     */
+    Long64_t Load(Long64_t evt) {
+        if (evt < 0 || evt >= fBoundaries.back()) {return 0;}
+        auto it = std::upper_bound(fBoundaries.begin(), fBoundaries.end(), evt);
+        Long64_t first = *(it - 1);
+        Int_t count = fBranch->GetBulkRead().GetEntriesSerialized(first, fBuffer, &fCountBuffer);
+        if (R__unlikely(count < 0)) {return -1;}
+
+        Int_t *lengths = reinterpret_cast<Int_t*>(fCountBuffer.GetCurrent());
+        DecodeBigEndianInPlace(lengths, count);
+        Long64_t total = 0;
+        for (Int_t idx = 0; idx < count; idx++) {total += lengths[idx];}
+        fValues.resize(total);
+        fOffsets.resize(count + 1);
+
+        const char *entry_buf = fBuffer.GetCurrent();
+        Long64_t offset = 0;
+        for (Int_t idx = 0; idx < count; idx++) {
+            fOffsets[idx] = offset;
+            char is_array = *entry_buf++;
+            if (!is_array) {continue;}
+            DecodeBigEndian(entry_buf, fValues.data() + offset, lengths[idx]);
+            entry_buf += lengths[idx] * sizeof(T);
+            offset += lengths[idx];
+        }
+        fOffsets[count] = offset;
+        fValues.resize(offset);
+        fFirst = first;
+        fEvents = count;
+        return count;
+    }
+
+    /// True if `evt` lies in the currently loaded basket.
+    bool Contains(Long64_t evt) const {return (evt >= fFirst) && (evt < fFirst + fEvents);}
+
+    Long64_t GetFirstEntry() const {return fFirst;}
+    Long64_t GetEvents() const {return fEvents;}
+
+    /// All values of the loaded basket, and the offsets (GetEvents()+1 of them) into it.
+    const T *GetValues() const {return fValues.data();}
+    const Long64_t *GetOffsets() const {return fOffsets.data();}
+
+    /// Values and length of entry `evt`, which must satisfy Contains(evt).
+    const T *GetArray(Long64_t evt) const {return fValues.data() + fOffsets[evt - fFirst];}
+    Long64_t GetSize(Long64_t evt) const {return fOffsets[evt - fFirst + 1] - fOffsets[evt - fFirst];}
+
+private:
+    TBranch *fBranch;
+    std::vector<Long64_t> fBoundaries;
+    TBufferFile fBuffer{TBuffer::kWrite, 32*1024};
+    TBufferFile fCountBuffer{TBuffer::kWrite, 32*1024};
+    std::vector<T> fValues;
+    std::vector<Long64_t> fOffsets;
+    Long64_t fFirst{0};
+    Long64_t fEvents{0};
+};
+
+#endif  // BULKAPI_JAGGED_BULK_READER_H
@@ -0,0 +1,278 @@
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <sstream>
+#include <utility>
+
+#include "LoopbackFileServer.h"
+
+static const char kBoundary[] = "LoopbackFileServerBoundary";
+static const size_t kChunkSize = 64*1024;
+
+static bool SendAll(int fd, const char *data, size_t len) {
+    while (len) {
+        ssize_t nsent = send(fd, data, len, MSG_NOSIGNAL);
+        if (nsent < 0 && errno == EINTR) {continue;}
+        if (nsent <= 0) {return false;}
+        data += nsent;
+        len -= nsent;
+    }
+    return true;
+}
+
+/// Value of the header `name` in `request`, or an empty string.
+static std::string GetHeader(const std::string &request, const char *name) {
+    std::istringstream lines(request);
+    std::string line;
+    size_t len = strlen(name);
+    while (std::getline(lines, line)) {
+        if ((line.size() > len) && (line[len] == ':') && !strncasecmp(line.c_str(), name, len)) {
+            size_t start = line.find_first_not_of(' ', len + 1);
+            size_t end = line.find_last_not_of("\r ");
+            return (start == std::string::npos) ? "" : line.substr(start, end + 1 - start);
+        }
+    }
+    return "";
+}
+
+/**
+ * Parse "bytes=a-b,c-,-n" into inclusive [first, last] pairs clipped to
+ * `size`.  Returns false if the header is malformed or no range overlaps the
+ * file.
+ */
+static bool ParseRanges(const std::string &header, Long64_t size, std::vector<std::pair<Long64_t, Long64_t>> &ranges) {
+    if (header.compare(0, 6, "bytes=")) {return false;}
+    std::stringstream ss(header.substr(6));
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        item.erase(0, item.find_first_not_of(' '));
+        size_t dash = item.find('-');
+        if (dash == std::string::npos) {return false;}
+        std::string from = item.substr(0, dash), to = item.substr(dash + 1);
+        Long64_t first, last;
+        if (from.empty()) {
+            if (to.empty()) {return false;}
+            first = std::max(size - atoll(to.c_str()), 0LL);
+            last = size - 1;
+        } else {
+            first = atoll(from.c_str());
+            last = to.empty() ? size - 1 : std::min(atoll(to.c_str()), size - 1);
+        }
+        if ((first >= size) || (last < first)) {continue;}
+        ranges.emplace_back(first, last);
+    }
+    return !ranges.empty();
+}
+
+LoopbackFileServer::LoopbackFileServer(const char *fname, double latency_ms, double bandwidth_MBps)
+    : fFileName(fname), fLatencyMs(latency_ms), fBytesPerSecond(bandwidth_MBps * 1e6) {
+    const char *base = strrchr(fname, '/');
+    fPath = std::string("/") + (base ? base + 1 : fname);
+}
+
+LoopbackFileServer::~LoopbackFileServer() {
+    Stop();
+    if (fFd >= 0) {close(fFd);}
+}
+
+bool LoopbackFileServer::Start() {
+    fFd = open(fFileName.c_str(), O_RDONLY);
+    struct stat st;
+    if ((fFd < 0) || fstat(fFd, &st)) {
+        printf("Failed to open %s to serve it: %s\n", fFileName.c_str(), strerror(errno));
+        return false;
+    }
+    fSize = st.st_size;
+
+    fListen = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t addr_len = sizeof(addr);
+    if ((fListen < 0) || bind(fListen, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) ||
+        listen(fListen, 64) || getsockname(fListen, reinterpret_cast<struct sockaddr*>(&addr), &addr_len)) {
+        printf("Failed to listen on the loopback interface: %s\n", strerror(errno));
+        return false;
+    }
+    fURL = "http://127.0.0.1:" + std::to_string(ntohs(addr.sin_port)) + fPath;
+    fAcceptThread = std::thread(&LoopbackFileServer::Accept, this);
+    return true;
+}
+
+void LoopbackFileServer::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        if (fStopping) {return;}
+        fStopping = true;
+        // Wakes accept() and every recv(); the threads then exit.
+        if (fListen >= 0) {shutdown(fListen, SHUT_RDWR);}
+        for (int client : fClients) {shutdown(client, SHUT_RDWR);}
+    }
+    if (fAcceptThread.joinable()) {fAcceptThread.join();}
+    // Connection threads are detached; each closes its own socket on the way out.
+    std::unique_lock<std::mutex> lock(fMutex);
+    fCond.wait(lock, [this] {return !fLive;});
+    if (fListen >= 0) {close(fListen);}
+}
+
+void LoopbackFileServer::Accept() {
+    while (true) {
+        int client = accept(fListen, nullptr, nullptr);
+        if (client < 0) {
+            int error = errno;
+            {
+                std::lock_guard<std::mutex> lock(fMutex);
+                if (fStopping) {return;}
+            }
+            if ((error == EINTR) || (error == ECONNABORTED)) {continue;}
+            printf("Loopback file server failed to accept a connection: %s\n", strerror(error));
+            // Out of descriptors or memory: wait for connections to finish instead of giving up.
+            if ((error == EMFILE) || (error == ENFILE) || (error == ENOBUFS) || (error == ENOMEM)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                continue;
+            }
+            return;
+        }
+        int one = 1;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        std::lock_guard<std::mutex> lock(fMutex);
+        if (fStopping) {
+            close(client);
+            return;
+        }
+        fClients.push_back(client);
+        fLive++;
+        std::thread(&LoopbackFileServer::Serve, this, client).detach();
+    }
+}
+
+void LoopbackFileServer::Close(int client) {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fClients.erase(std::find(fClients.begin(), fClients.end(), client));
+    close(client);
+    fLive--;
+    // Last use of this object by the connection thread: Stop() may return as soon as the lock is released.
+    fCond.notify_all();
+}
+
+void LoopbackFileServer::Serve(int client) {
+    std::string pending;
+    char buf[4096];
+    bool keep_alive = true;
+    while (keep_alive) {
+        size_t end;
+        ssize_t nread = 1;
+        while ((end = pending.find("\r\n\r\n")) == std::string::npos) {
+            nread = recv(client, buf, sizeof(buf), 0);
+            if (nread < 0 && errno == EINTR) {continue;}
+            if (nread <= 0) {break;}
+            pending.append(buf, nread);
+        }
+        if (nread <= 0) {break;}
+        std::string request = pending.substr(0, end + 4);
+        pending.erase(0, end + 4);
+        if (!Respond(client, request, keep_alive)) {break;}
+    }
+    Close(client);
+}
+
+bool LoopbackFileServer::Respond(int client, const std::string &request, bool &keep_alive) {
+    fRequests++;
+    std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(fLatencyMs));
+
+    std::istringstream line(request.substr(0, request.find("\r\n")));
+    std::string method, target, version;
+    line >> method >> target >> version;
+    std::string connection = GetHeader(request, "Connection");
+    keep_alive = (version == "HTTP/1.1") ? strcasecmp(connection.c_str(), "close")
+                                         : !strcasecmp(connection.c_str(), "keep-alive");
+    std::string common = std::string("Accept-Ranges: bytes\r\nConnection: ") + (keep_alive ? "keep-alive" : "close") + "\r\n";
+
+    if (((method != "GET") && (method != "HEAD")) || (target.substr(0, target.find('?')) != fPath)) {
+        std::string response = (method == "GET" || method == "HEAD") ? "HTTP/1.1 404 Not Found\r\n" : "HTTP/1.1 405 Method Not Allowed\r\n";
+        response += common + "Content-Length: 0\r\n\r\n";
+        return SendAll(client, response.data(), response.size());
+    }
+    bool head = (method == "HEAD");
+    std::vector<std::pair<Long64_t, Long64_t>> ranges;
+    std::string range = GetHeader(request, "Range");
+    if (range.empty()) {
+        ranges.emplace_back(0, fSize - 1);
+    } else if (!ParseRanges(range, fSize, ranges)) {
+        std::string response = "HTTP/1.1 416 Range Not Satisfiable\r\n" + common +
+                               "Content-Range: bytes */" + std::to_string(fSize) + "\r\nContent-Length: 0\r\n\r\n";
+        return SendAll(client, response.data(), response.size());
+    }
+    fRanges += ranges.size();
+
+    // Part headers for a multipart response, so the total length is known up front.
+    std::vector<std::string> parts;
+    Long64_t length = 0;
+    std::string header;
+    if (range.empty()) {
+        header = "HTTP/1.1 200 OK\r\n" + common + "Content-Type: application/octet-stream\r\n";
+        length = fSize;
+    } else if (ranges.size() == 1) {
+        header = "HTTP/1.1 206 Partial Content\r\n" + common + "Content-Type: application/octet-stream\r\n" +
+                 "Content-Range: bytes " + std::to_string(ranges[0].first) + "-" + std::to_string(ranges[0].second) +
+                 "/" + std::to_string(fSize) + "\r\n";
+        length = ranges[0].second - ranges[0].first + 1;
+    } else {
+        header = "HTTP/1.1 206 Partial Content\r\n" + common +
+                 "Content-Type: multipart/byteranges; boundary=" + kBoundary + "\r\n";
+        for (const auto &part : ranges) {
+            parts.push_back(std::string("\r\n--") + kBoundary + "\r\nContent-Type: application/octet-stream\r\n" +
+                            "Content-Range: bytes " + std::to_string(part.first) + "-" + std::to_string(part.second) +
+                            "/" + std::to_string(fSize) + "\r\n\r\n");
+            length += parts.back().size() + part.second - part.first + 1;
+        }
+        parts.push_back(std::string("\r\n--") + kBoundary + "--\r\n");
+        length += parts.back().size();
+    }
+    header += "Content-Length: " + std::to_string(length) + "\r\n\r\n";
+    if (!SendAll(client, header.data(), header.size())) {return false;}
+    if (head) {return true;}
+
+    auto start = std::chrono::steady_clock::now();
+    Long64_t sent = 0;
+    std::vector<char> chunk(kChunkSize);
+    for (size_t idx = 0; idx < ranges.size(); idx++) {
+        if (!parts.empty() && !SendThrottled(client, parts[idx].data(), parts[idx].size(), sent, start)) {return false;}
+        for (Long64_t offset = ranges[idx].first; offset <= ranges[idx].second; offset += kChunkSize) {
+            size_t len = std::min<Long64_t>(kChunkSize, ranges[idx].second + 1 - offset);
+            if (pread(fFd, chunk.data(), len, offset) != static_cast<ssize_t>(len)) {
+                printf("Failed to read %s at offset %lld.\n", fFileName.c_str(), offset);
+                return false;
+            }
+            if (!SendThrottled(client, chunk.data(), len, sent, start)) {return false;}
+        }
+    }
+    if (!parts.empty() && !SendThrottled(client, parts.back().data(), parts.back().size(), sent, start)) {return false;}
+    return true;
+}
+
+bool LoopbackFileServer::SendThrottled(int client, const char *data, size_t len, Long64_t &sent,
+                                       std::chrono::steady_clock::time_point start) {
+    if (!SendAll(client, data, len)) {return false;}
+    sent += len;
+    fBytesSent += len;
+    if (fBytesPerSecond > 0) {
+        std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(sent / fBytesPerSecond)));
+    }
+    return true;
+}
@@ -0,0 +1,78 @@
+#ifndef BULKAPI_LOOPBACK_FILE_SERVER_H
+#define BULKAPI_LOOPBACK_FILE_SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Rtypes.h"
+
+/**
+ * A stand-in for remote storage: serves one local file over HTTP on
+ * 127.0.0.1, so ROOT can open it by URL (TWebFile or TDavixFile).
+ *
+ * HEAD and GET requests are supported, with single and multiple byte
+ * ranges; several ranges come back as one multipart/byteranges response,
+ * as a vectored TTreeCache read expects.  Every request waits `latency_ms`
+ * before it is answered, modelling one network round trip, and bodies are
+ * sent at no more than `bandwidth_MBps` per connection (0 means
+ * unlimited).  Connections are kept alive, and each gets its own detached
+ * thread, which closes the socket when the client is done.
+ *
+ * The request counters tell how many round trips a reader made.
+ */
+class LoopbackFileServer {
+public:
+    LoopbackFileServer(const char *fname, double latency_ms, double bandwidth_MBps);
+    ~LoopbackFileServer();
+    LoopbackFileServer(const LoopbackFileServer &) = delete;
+    LoopbackFileServer &operator=(const LoopbackFileServer &) = delete;
+
+    /// Listen on an ephemeral loopback port.  Returns false on error.
+    bool Start();
+    void Stop();
+
+    /// URL of the served file, for TFile::Open.
+    const std::string &GetURL() const {return fURL;}
+
+    /// Requests answered so far, each one a round trip.
+    Long64_t GetRequests() const {return fRequests;}
+    /// Byte ranges asked for; a multi-range request counts each range.
+    Long64_t GetRanges() const {return fRanges;}
+    /// Body bytes sent.
+    Long64_t GetBytesSent() const {return fBytesSent;}
+
+private:
+    void Accept();
+    void Serve(int client);
+    void Close(int client);
+    bool Respond(int client, const std::string &request, bool &keep_alive);
+    bool SendThrottled(int client, const char *data, size_t len, Long64_t &sent,
+                       std::chrono::steady_clock::time_point start);
+
+    std::string fFileName;
+    std::string fPath;      // Path component of the URL.
+    std::string fURL;
+    double fLatencyMs;
+    double fBytesPerSecond;
+    int fFd{-1};
+    Long64_t fSize{0};
+    int fListen{-1};
+
+    std::thread fAcceptThread;
+    std::mutex fMutex;      // Guards fClients, fLive and fStopping.
+    std::condition_variable fCond;  // Signalled when a connection thread finishes.
+    std::vector<int> fClients;  // Open client sockets.
+    int fLive{0};           // Connection threads still running.
+    bool fStopping{false};
+
+    std::atomic<Long64_t> fRequests{0};
+    std::atomic<Long64_t> fRanges{0};
+    std::atomic<Long64_t> fBytesSent{0};
+};
+
+#endif  // BULKAPI_LOOPBACK_FILE_SERVER_H
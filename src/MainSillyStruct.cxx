@@ -10,6 +10,8 @@
 #include "TTreeReaderValue.h"
 #include "ROOT/TBulkBranchRead.hxx"
 
+#include "AllocationCounter.h"
+#include "MultiBranchBulkReader.h"
 #include "SillyStruct.h"
 
 int main(int argc, char *argv[]) {
@@ -17,21 +19,48 @@ int main(int argc, char *argv[]) {
     TFile *hfile;
     TTree *tree;
 
-    if (argc != 3) {
-        fprintf(stderr, "Usage: %s [read|write] [bulk|standard]\n", argv[0]);
+    if ((argc != 3) && (argc != 4)) {
+        fprintf(stderr, "Usage: %s read [bulk|bulksplit|standard] [quiet]\n", argv[0]);
+        fprintf(stderr, "       %s write [bulk|bulksplit|standard] [events]\n", argv[0]);
         return 1;
     }
     const std::string fname = "SillyStruct.root";
 
-    bool do_std = false;
+    bool do_std = false, do_split = false;
     if (!strcmp(argv[2], "standard")) {
         do_std = true;
+    } else if (!strcmp(argv[2], "bulksplit")) {
+        do_split = true;
     } else if (strcmp(argv[2], "bulk")) {
-        fprintf(stderr, "Second argument must either be 'bulk' or 'standard'.\n");
+        fprintf(stderr, "Second argument must be 'bulk', 'bulksplit' or 'standard'.\n");
         return 1;
     }
 
+    // 'quiet' replaces the per-entry printout with a single checksum, so the loop can be timed.
+    bool quiet = false;
+    Long64_t write_events = 10;
+    if (argc == 4) {
+        if (!strcmp(argv[1], "read")) {
+            if (strcmp(argv[3], "quiet")) {
+                fprintf(stderr, "Third argument for reads must be 'quiet'.\n");
+                return 1;
+            }
+            quiet = true;
+        } else {
+            try {
+                write_events = std::stoll(argv[3]);
+            } catch (...) {
+                fprintf(stderr, "Failed to parse third argument (%s) to integer.\n", argv[3]);
+                return 1;
+            }
+        }
+    }
+
     if (strcmp(argv[1], "read") == 0) {
+        // Heap activity before sw.Start() is setup; everything after it is the read loop.
+        AllocationCounts before = GetAllocationCounts(), setup;
+        Long64_t events = 0;
+        double checksum = 0;
         hfile = new TFile(fname.c_str());
         printf("Starting read of file %s.\n", fname.c_str());
         TStopwatch sw;
@@ -40,15 +69,49 @@ int main(int argc, char *argv[]) {
            // Read via standard APIs.
            printf("Using standard read APIs.\n");
            TTreeReader myReader("T", hfile);
-           TTreeReaderValue<float> a(myReader, "a");
-           TTreeReaderValue<int> b(myReader, "b");
-           TTreeReaderValue<double> c(myReader, "c");
            TTreeReaderValue<float> myF(myReader, "myFloat");
+           // Members are read through the object, so each entry deserializes a whole SillyStruct.
            TTreeReaderValue<SillyStruct> ss(myReader, "myEvent");
+           setup = GetAllocationCounts();
            sw.Start();
            while (myReader.Next()) {
-              std::cout << "A=" << *a << ", B=" << *b << ", C=" << *c << ", myFloat=" << *myF << "\n";
+              if (quiet) {
+                 checksum += ss->a + ss->b + ss->c;
+              } else {
+                 std::cout << "A=" << ss->a << ", B=" << ss->b << ", C=" << ss->c << ", myFloat=" << *myF << "\n";
+              }
+              events++;
+           }
+
+        } else if (do_split) {
+           // Read every split member of myEvent, basket by basket, into one array per member.
+           printf("Reading split SillyStruct members into arrays using bulk APIs.\n");
+           TTree *tree = dynamic_cast<TTree*>(hfile->Get("T"));
+           if (!tree) {
+              std::cout << "Failed to fetch tree named 'T' from input file.\n";
+              return 1;
            }
+           MultiBranchBulkReader<float, Int_t, double> reader(tree, {{"a", "b", "c"}});
+           if (!reader.IsValid()) {return 1;}
+           setup = GetAllocationCounts();
+           sw.Start();
+           Long64_t count;
+           while ((count = reader.Next()) > 0) {
+              const float *a = reader.Get<0>();
+              const Int_t *b = reader.Get<1>();
+              const double *c = reader.Get<2>();
+              if (quiet) {
+                 for (Long64_t idx=0; idx<count; idx++) {
+                    checksum += a[idx] + b[idx] + c[idx];
+                 }
+              } else {
+                 for (Long64_t idx=0; idx<count; idx++) {
+                    std::cout << "A=" << a[idx] << ", B=" << b[idx] << ", C=" << c[idx] << "\n";
+                 }
+              }
+              events += count;
+           }
+           if (count < 0) {return 1;}
 
         } else {
            std::cout << "Reading using bulk APIs.\n";
@@ -65,6 +128,7 @@ int main(int argc, char *argv[]) {
               std::cout << "Unable to find branch 'a' in tree 'T'\n";
               return 1;
            }
+           setup = GetAllocationCounts();
            sw.Start();
            auto count = branchF->GetBulkRead().GetEntriesFast(0, branchbuf);
            if (count < 0) {
@@ -72,13 +136,28 @@ int main(int argc, char *argv[]) {
               return 1;
            }
            float *entry = reinterpret_cast<float*>(branchbuf.GetCurrent());
-           for (Int_t idx=0; idx<count; idx++) {
-              std::cout << "myFloat=" << entry[idx] << "\n";
+           if (quiet) {
+              for (Int_t idx=0; idx<count; idx++) {
+                 checksum += entry[idx];
+              }
+           } else {
+              for (Int_t idx=0; idx<count; idx++) {
+                 std::cout << "myFloat=" << entry[idx] << "\n";
+              }
            }
+           events = count;
        }
        sw.Stop();
+       AllocationCounts after = GetAllocationCounts();
        printf("Successful read of all events.\n");
-       printf("Total elapsed time (seconds) for reads: %.2f\n", sw.RealTime());
+       if (quiet) {printf("Read %lld events, checksum %.17g\n", events, checksum);}
+       printf("Total elapsed time (seconds) for reads: %.6f\n", sw.RealTime());
+       if (AllocationCountingActive()) {
+          printf("Setup allocations: %lld (%lld bytes)\n", setup.allocations - before.allocations, setup.bytes - before.bytes);
+          printf("Read loop allocations: %lld (%lld bytes, %.2f per event)\n", after.allocations - setup.allocations,
+                 after.bytes - setup.bytes, events ? (double)(after.allocations - setup.allocations) / events : 0);
+          printf("Peak heap: %.1f MB, peak RSS: %.1f MB\n", GetPeakLiveBytes() / 1e6, GetPeakRSS() / 1e6);
+       }
     } else if (strcmp(argv[1], "write") == 0) {
         hfile = new TFile("SillyStruct.root","RECREATE","TTree benchmark ROOT file");
         hfile->SetCompressionLevel(1);
@@ -91,14 +170,18 @@ int main(int argc, char *argv[]) {
         branch2->SetAutoDelete(kFALSE);
         ss.b = 2;
         ss.c = 3;
-        for (int ev = 0; ev < 10; ev++) {
+        TStopwatch sw;
+        sw.Start();
+        for (Long64_t ev = 0; ev < write_events; ev++) {
           ss.a = ev+1;
           f = ss.a+1;
           tree->Fill();
         }
         hfile = tree->GetCurrentFile();
         hfile->Write();
+        sw.Stop();
         tree->Print();
+        printf("Total elapsed time (seconds) for writes: %.6f\n", sw.RealTime());
     } else {
         fprintf(stderr, "Unknown command: %s.\n", argv[1]);
         return 1;
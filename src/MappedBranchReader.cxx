@@ -0,0 +1,100 @@
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "TBranch.h"
+
+#include "BasketUtils.h"
+#include "MappedBranchReader.h"
+
+// Every basket starts with a TKey header: Nbytes (4 bytes), Version (2),
+// ObjLen (4), Datime (4), KeyLen (2), ...; the payload follows after KeyLen
+// bytes.  All fields are big-endian.
+static const size_t kKeyHeaderMin = 16;
+
+static int32_t ReadInt32(const char *ptr) {
+    uint32_t raw;
+    memcpy(&raw, ptr, 4);
+    return static_cast<int32_t>(__builtin_bswap32(raw));
+}
+
+static int16_t ReadInt16(const char *ptr) {
+    uint16_t raw;
+    memcpy(&raw, ptr, 2);
+    return static_cast<int16_t>(__builtin_bswap16(raw));
+}
+
+MappedBranchReader::MappedBranchReader(const char *fname, TBranch *branch, size_t entry_size)
+    : fBranch(branch), fEntrySize(entry_size), fBoundaries(GetBasketBoundaries(branch)) {
+    int fd = open(fname, O_RDONLY);
+    if (fd < 0) {
+        printf("Failed to open %s for mapping.\n", fname);
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) || st.st_size == 0) {
+        printf("Failed to get the size of %s.\n", fname);
+        close(fd);
+        return;
+    }
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping keeps its own reference to the file.
+    close(fd);
+    if (map == MAP_FAILED) {
+        printf("Failed to map %s.\n", fname);
+        return;
+    }
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+    fMap = static_cast<const char*>(map);
+    fMapSize = st.st_size;
+}
+
+MappedBranchReader::~MappedBranchReader() {
+    if (fMap) {munmap(const_cast<char*>(fMap), fMapSize);}
+}
+
+Long64_t MappedBranchReader::GetEntriesMapped(Long64_t evt, const char *&data) {
+    if (evt >= fBoundaries.back()) {return 0;}
+    if ((fBasket >= static_cast<Int_t>(fBoundaries.size()) - 1) || (fBoundaries[fBasket] != evt)) {
+        auto it = std::upper_bound(fBoundaries.begin(), fBoundaries.end(), evt);
+        fBasket = (it - fBoundaries.begin()) - 1;
+        if (fBoundaries[fBasket] != evt) {
+            printf("Entry %lld of branch '%s' is not at a basket boundary.\n", evt, fBranch->GetName());
+            return -1;
+        }
+    }
+    if (fBasket >= fBranch->GetWriteBasket()) {
+        printf("Basket %d of branch '%s' was never written to the file.\n", fBasket, fBranch->GetName());
+        return -1;
+    }
+    Long64_t seek = fBranch->GetBasketSeek(fBasket);
+    Int_t nbytes = fBranch->GetBasketBytes()[fBasket];
+    if ((seek < 0) || (nbytes < static_cast<Int_t>(kKeyHeaderMin)) || (static_cast<size_t>(seek + nbytes) > fMapSize)) {
+        printf("Basket %d of branch '%s' lies outside the file.\n", fBasket, fBranch->GetName());
+        return -1;
+    }
+    const char *key = fMap + seek;
+    Int_t objlen = ReadInt32(key + 6);
+    Int_t keylen = ReadInt16(key + 14);
+    if (objlen + keylen != nbytes) {
+        printf("Basket %d of branch '%s' is compressed; mapped reads need a file written with compression 0.\n",
+               fBasket, fBranch->GetName());
+        return -1;
+    }
+    Long64_t count = fBoundaries[fBasket + 1] - evt;
+    // Fixed-size entries carry no offset array, so the payload is exactly the values.
+    if (static_cast<size_t>(objlen) != count * fEntrySize) {
+        printf("Basket %d of branch '%s' holds %d bytes, expected %lld entries of %zu bytes.\n",
+               fBasket, fBranch->GetName(), objlen, count, fEntrySize);
+        return -1;
+    }
+    data = key + keylen;
+    fBasket++;
+    return count;
+}
@@ -0,0 +1,94 @@
+#ifndef BULKAPI_MAPPED_BRANCH_READER_H
+#define BULKAPI_MAPPED_BRANCH_READER_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#include "Rtypes.h"
+
+#include "ByteSwap.h"
+
+class TBranch;
+
+/**
+ * Zero-copy access to the baskets of a fixed-size branch in an uncompressed
+ * file.
+ *
+ * The whole file is mapped read-only and each basket's payload is located
+ * from the branch's basket seek table and the basket's key header, so the
+ * entries are never copied out of the page cache.  The view is of the
+ * serialized, big-endian values; BigEndianView decodes them only when asked.
+ *
+ * Compressed baskets cannot be viewed in place; GetEntriesMapped() reports
+ * them as an error.
+ */
+class MappedBranchReader {
+public:
+    MappedBranchReader(const char *fname, TBranch *branch, size_t entry_size);
+    ~MappedBranchReader();
+    MappedBranchReader(const MappedBranchReader &) = delete;
+    MappedBranchReader &operator=(const MappedBranchReader &) = delete;
+
+    /// False if the file could not be mapped; the message has already been printed.
+    bool IsValid() const {return fMap != nullptr;}
+
+    /**
+     * Point `data` at the serialized entries of the basket starting at entry
+     * `evt`, which must be a basket boundary.  Returns the number of entries,
+     * 0 past the end of the branch and -1 (after printing why) if the basket
+     * is compressed or does not look like a basket of this branch.
+     */
+    Long64_t GetEntriesMapped(Long64_t evt, const char *&data);
+
+private:
+    TBranch *fBranch;
+    size_t fEntrySize;
+    std::vector<Long64_t> fBoundaries;
+    Int_t fBasket{0};  // Next basket, for the usual in-order access.
+    const char *fMap{nullptr};
+    size_t fMapSize{0};
+};
+
+/**
+ * Big-endian values of type T seen through a pointer into a mapping or a
+ * serialized buffer.  Indexing decodes one value; Decode() converts a whole
+ * run with the SIMD kernels.
+ */
+template<typename T>
+class BigEndianView {
+public:
+    BigEndianView(const char *data, Long64_t size) : fData(data), fSize(size) {}
+
+    Long64_t size() const {return fSize;}
+
+    T operator[](Long64_t idx) const {
+        T value;
+        Swap(fData + idx * sizeof(T), &value);
+        return value;
+    }
+
+    void Decode(T *dst) const {DecodeBigEndian(fData, dst, fSize);}
+
+private:
+    static void Swap(const char *src, T *dst) {
+        static_assert(sizeof(T) == 4 || sizeof(T) == 8, "BigEndianView supports 32- and 64-bit types");
+        if (sizeof(T) == 4) {
+            uint32_t raw;
+            memcpy(&raw, src, 4);
+            raw = __builtin_bswap32(raw);
+            memcpy(dst, &raw, 4);
+        } else {
+            uint64_t raw;
+            memcpy(&raw, src, 8);
+            raw = __builtin_bswap64(raw);
+            memcpy(dst, &raw, 8);
+        }
+    }
+
+    const char *fData;
+    Long64_t fSize;
+};
+
+#endif  // BULKAPI_MAPPED_BRANCH_READER_H
@@ -0,0 +1,174 @@
+
+#include <stdio.h>
+#include <string.h>
+
+#include <array>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "TBranch.h"
+#include "TFile.h"
+#include "TStopwatch.h"
+#include "TTree.h"
+
+#include "MultiBranchBulkReader.h"
+
+// Column k has the k % 4'th type here, so any prefix of the columns mixes 4- and 8-byte widths.
+typedef std::tuple<float, double, Int_t, Long64_t> ColumnTypes;
+static const size_t kMaxColumns = 16;
+static const char *kColumnNames[kMaxColumns] = {
+    "col0", "col1", "col2", "col3", "col4", "col5", "col6", "col7",
+    "col8", "col9", "col10", "col11", "col12", "col13", "col14", "col15"
+};
+
+template<size_t I>
+using ColumnType = typename std::tuple_element<I % 4, ColumnTypes>::type;
+
+template<typename T>
+static double SumColumn(const T *values, Long64_t count) {
+    double sum = 0;
+    for (Long64_t idx = 0; idx < count; idx++) {sum += values[idx];}
+    return sum;
+}
+
+/**
+ * Read the first N columns together and sum every value, so each column's
+ * data is actually touched.  Returns the number of entries read, or -1.
+ */
+template<size_t... Is>
+static Long64_t ReadColumns(TTree *tree, Long64_t events, std::index_sequence<Is...>, double &checksum, Long64_t &bytes) {
+    MultiBranchBulkReader<ColumnType<Is>...> reader(tree, {{kColumnNames[Is]...}}, events);
+    if (!reader.IsValid()) {return -1;}
+    Long64_t total = 0, count;
+    while ((count = reader.Next()) > 0) {
+        double sums[] = {0, SumColumn(reader.template Get<Is>(), count)...};
+        for (double sum : sums) {checksum += sum;}
+        total += count;
+    }
+    if (count < 0) {return -1;}
+    size_t widths[] = {0, sizeof(ColumnType<Is>)...};
+    bytes = 0;
+    for (size_t width : widths) {bytes += width * total;}
+    return total;
+}
+
+// Template arguments have to be compile-time constants; walk down from the largest supported count.
+template<size_t N>
+static Long64_t ReadColumnCount(size_t columns, TTree *tree, Long64_t events, double &checksum, Long64_t &bytes) {
+    if (columns == N) {return ReadColumns(tree, events, std::make_index_sequence<N>(), checksum, bytes);}
+    return ReadColumnCount<N-1>(columns, tree, events, checksum, bytes);
+}
+
+template<>
+Long64_t ReadColumnCount<0>(size_t, TTree *, Long64_t, double &, Long64_t &) {
+    return -1;
+}
+
+static int Write(Long64_t events, const char *fname) {
+    TFile *hfile = new TFile(fname, "RECREATE", "TTree multi-branch micro benchmark ROOT file");
+    TTree *tree = new TTree("T", "A ROOT tree of mixed-width columns.");
+    float f[4];
+    double d[4];
+    Int_t i[4];
+    Long64_t l[4];
+    for (size_t col = 0; col < kMaxColumns; col++) {
+        static const char *kLeafTypes[] = {"F", "D", "I", "L"};
+        void *address[] = {&f[col/4], &d[col/4], &i[col/4], &l[col/4]};
+        std::string leaflist = std::string(kColumnNames[col]) + "/" + kLeafTypes[col % 4];
+        TBranch *branch = tree->Branch(kColumnNames[col], address[col % 4], leaflist.c_str(), 320000);
+        branch->SetAutoDelete(kFALSE);
+    }
+    TStopwatch sw;
+    sw.Start();
+    for (Long64_t ev = 0; ev < events; ev++) {
+        for (size_t slot = 0; slot < 4; slot++) {
+            f[slot] = ev + slot;
+            d[slot] = ev + slot;
+            i[slot] = ev + slot;
+            l[slot] = ev + slot;
+        }
+        tree->Fill();
+    }
+    hfile = tree->GetCurrentFile();
+    hfile->Write();
+    sw.Stop();
+    tree->Print();
+    printf("Successful write of all events.\n");
+    printf("Total elapsed time (seconds) for writes: %.2f\n", sw.RealTime());
+    hfile->Close();
+    return 0;
+}
+
+static int Read(Long64_t events, const char *fname, const std::vector<size_t> &column_counts) {
+    TFile *hfile = new TFile(fname);
+    TTree *tree = dynamic_cast<TTree*>(hfile->Get("T"));
+    if (!tree) {
+        printf("Failed to fetch tree named 'T' from input file.\n");
+        return 1;
+    }
+    printf("%8s %12s %10s %14s %10s %20s\n", "columns", "events", "time (s)", "events/s", "MB/s", "checksum");
+    for (size_t columns : column_counts) {
+        double checksum = 0;
+        Long64_t bytes = 0;
+        TStopwatch sw;
+        sw.Start();
+        Long64_t count = ReadColumnCount<kMaxColumns>(columns, tree, events, checksum, bytes);
+        sw.Stop();
+        if (count < 0) {
+            printf("Failed to read %zu columns.\n", columns);
+            return 1;
+        }
+        double seconds = sw.RealTime();
+        printf("%8zu %12lld %10.3f %14.4g %10.1f %20.6g\n", columns, count, seconds,
+               seconds > 0 ? count / seconds : 0, seconds > 0 ? bytes / seconds / 1e6 : 0, checksum);
+    }
+    hfile->Close();
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+
+    // Handle all the argument parsing up front.
+    if ((argc != 4) && (argc != 5)) {
+        fprintf(stderr, "Usage: %s read|write events fname [column counts, e.g. 1,2,4,8,16]\n", argv[0]);
+        return 1;
+    }
+    bool do_read = false;
+    if (!strcmp(argv[1], "read")) {
+        do_read = true;
+    } else if (strcmp(argv[1], "write")) {
+        fprintf(stderr, "First argument must be either 'read' or 'write'\n");
+        return 1;
+    }
+    Long64_t events;
+    try {
+        events = std::stoll(argv[2]);
+    } catch (...) {
+        fprintf(stderr, "Failed to parse second argument (%s) to integer.\n", argv[2]);
+        return 1;
+    }
+    const char *fname = argv[3];
+    std::vector<size_t> column_counts = {1, 2, 4, 8, 16};
+    if (argc == 5) {
+        column_counts.clear();
+        std::stringstream ss(argv[4]);
+        std::string count;
+        while (std::getline(ss, count, ',')) {
+            size_t columns = 0;
+            try {
+                columns = std::stoul(count);
+            } catch (...) {}
+            if ((columns < 1) || (columns > kMaxColumns)) {
+                fprintf(stderr, "Column counts must be between 1 and %zu (got %s).\n", kMaxColumns, count.c_str());
+                return 1;
+            }
+            column_counts.push_back(columns);
+        }
+    }
+    // End arg parsing.
+
+    return do_read ? Read(events, fname, column_counts) : Write(events, fname);
+}
@@ -0,0 +1,135 @@
+#ifndef BULKAPI_MULTI_BRANCH_BULK_READER_H
+#define BULKAPI_MULTI_BRANCH_BULK_READER_H
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <tuple>
+#include <utility>
+
+#include "Rtypes.h"
+#include "TBranch.h"
+#include "TBufferFile.h"
+#include "TTree.h"
+#include "ROOT/TBulkBranchRead.hxx"
+
+/**
+ * Bulk reader that keeps any number of branches, of possibly different
+ * types, in step.
+ *
+ * Every branch has its own basket boundaries.  Next() refills each branch
+ * whose basket is used up and returns the longest run of entries available
+ * in all of them at once; Get<I>() then points at that run in column I.
+ *
+ *     MultiBranchBulkReader<float, double> reader(tree, {"myFloat", "myDouble"});
+ *     while ((count = reader.Next()) > 0) {
+ *         const float *f = reader.Get<0>();
+ *         const double *g = reader.Get<1>();
+ *         ...
+ *     }
+ */
+template<typename... Ts>
+class MultiBranchBulkReader {
+public:
+    static constexpr size_t kColumns = sizeof...(Ts);
+
+    MultiBranchBulkReader(TTree *tree, const std::array<const char*, kColumns> &names, Long64_t last = -1)
+        : fColumns(std::unique_ptr<Column<Ts>>(new Column<Ts>())...),
+          fLast((last < 0) ? tree->GetEntries() : std::min(last, tree->GetEntries())) {
+        Init(tree, names, std::index_sequence_for<Ts...>());
+    }
+
+    /// False if any of the branches could not be found; the message has already been printed.
+    bool IsValid() const {return fValid;}
+
+    /**
+     * Advance to the next batch.  Returns the number of entries in it, 0 at
+     * the end of the range and -1 if a basket could not be read.
+     */
+    Long64_t Next() {
+        fFirst += fCount;
+        if (fFirst >= fLast) {
+            fCount = 0;
+            return 0;
+        }
+        Long64_t count = fLast - fFirst;
+        if (!Refill(count, std::index_sequence_for<Ts...>())) {
+            fCount = 0;
+            return -1;
+        }
+        fCount = count;
+        return count;
+    }
+
+    /// First entry of the current batch.
+    Long64_t GetFirstEntry() const {return fFirst;}
+
+    /// Values of column I for the current batch.
+    template<size_t I>
+    const typename std::tuple_element<I, std::tuple<Ts...>>::type *Get() const {
+        return std::get<I>(fColumns)->Current(fFirst);
+    }
+
+private:
+    template<typename T>
+    struct Column {
+        TBranch *branch{nullptr};
+        TBufferFile buf{TBuffer::kWrite, 32*1024};
+        Long64_t basket_first{0};   // First entry in buf.
+        Long64_t basket_end{0};     // One past the last entry in buf.
+
+        const T *Current(Long64_t evt) const {
+            return reinterpret_cast<const T*>(buf.GetCurrent()) + (evt - basket_first);
+        }
+
+        /// Make sure evt is loaded; shrink count to what this column can supply from evt.
+        bool Refill(Long64_t evt, Long64_t &count) {
+            if (evt >= basket_end) {
+                // Consumption is in order, so evt is the first entry of this branch's next basket.
+                Int_t n = branch->GetBulkRead().GetEntriesFast(evt, buf);
+                if (R__unlikely(n <= 0)) {
+                    printf("Failed to get entries via the 'fast' method on branch '%s' for index %lld.\n",
+                           branch->GetName(), evt);
+                    return false;
+                }
+                basket_first = evt;
+                basket_end = evt + n;
+            }
+            count = std::min(count, basket_end - evt);
+            return true;
+        }
+    };
+
+    template<size_t... Is>
+    void Init(TTree *tree, const std::array<const char*, kColumns> &names, std::index_sequence<Is...>) {
+        bool found[] = {true, InitColumn(*std::get<Is>(fColumns), tree, names[Is])...};
+        fValid = std::all_of(std::begin(found), std::end(found), [](bool ok) {return ok;});
+    }
+
+    template<typename T>
+    static bool InitColumn(Column<T> &column, TTree *tree, const char *name) {
+        column.branch = tree->GetBranch(name);
+        if (!column.branch) {
+            printf("Unable to find branch '%s' in tree '%s'\n", name, tree->GetName());
+            return false;
+        }
+        return true;
+    }
+
+    template<size_t... Is>
+    bool Refill(Long64_t &count, std::index_sequence<Is...>) {
+        bool ok[] = {true, std::get<Is>(fColumns)->Refill(fFirst, count)...};
+        return std::all_of(std::begin(ok), std::end(ok), [](bool result) {return result;});
+    }
+
+    // Columns are heap-allocated so the TBufferFiles never move.
+    std::tuple<std::unique_ptr<Column<Ts>>...> fColumns;
+    Long64_t fLast;
+    Long64_t fFirst{0};
+    Long64_t fCount{0};
+    bool fValid{false};
+};
+
+#endif  // BULKAPI_MULTI_BRANCH_BULK_READER_H
@@ -0,0 +1,134 @@
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "PageCache.h"
+
+// O_DIRECT needs the offset, length and buffer aligned to the logical block
+// size of the device; 4 KiB covers every common one.
+static const size_t kDirectAlignment = 4096;
+
+bool ParsePageCache(const char *name, PageCache &state) {
+    if (!strcmp(name, "asis")) {
+        state = PageCache::kAsIs;
+    } else if (!strcmp(name, "cold")) {
+        state = PageCache::kCold;
+    } else if (!strcmp(name, "warm")) {
+        state = PageCache::kWarm;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char *GetPageCacheName(PageCache state) {
+    switch (state) {
+    case PageCache::kAsIs:
+        return "asis";
+    case PageCache::kCold:
+        return "cold";
+    case PageCache::kWarm:
+        return "warm";
+    }
+    return "unknown";
+}
+
+static double ResidentFraction(int fd, size_t size) {
+    if (!size) {return 0;}
+    void *map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {return -1;}
+    long page = sysconf(_SC_PAGESIZE);
+    std::vector<unsigned char> pages((size + page - 1) / page);
+    double fraction = -1;
+    if (!mincore(map, size, pages.data())) {
+        size_t resident = 0;
+        for (unsigned char bits : pages) {resident += bits & 1;}
+        fraction = static_cast<double>(resident) / pages.size();
+    }
+    munmap(map, size);
+    return fraction;
+}
+
+bool PreparePageCache(const char *fname, PageCache state, double &resident) {
+    resident = -1;
+    if (state == PageCache::kAsIs) {return true;}
+    int fd = open(fname, O_RDONLY);
+    struct stat st;
+    if ((fd < 0) || fstat(fd, &st)) {
+        printf("Failed to open %s to set its page cache state: %s\n", fname, strerror(errno));
+        if (fd >= 0) {close(fd);}
+        return false;
+    }
+    int error = 0;
+    if (state == PageCache::kCold) {
+        // Dirty pages are not dropped, so write back anything a write mode left behind first.
+        // posix_fadvise returns its error instead of setting errno.
+        error = fsync(fd) ? errno : posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    } else {
+        std::vector<char> buf(1024*1024);
+        ssize_t nread;
+        while ((nread = read(fd, buf.data(), buf.size())) > 0) {}
+        if (nread < 0) {error = errno;}
+    }
+    bool ok = !error;
+    if (!ok) {
+        printf("Failed to make %s %s in the page cache: %s\n", fname, GetPageCacheName(state), strerror(error));
+    } else {
+        resident = ResidentFraction(fd, st.st_size);
+    }
+    close(fd);
+    return ok;
+}
+
+RawFileReader::~RawFileReader() {
+    if (fFd >= 0) {close(fFd);}
+    free(fBounce);
+}
+
+bool RawFileReader::Open(const char *fname, bool direct) {
+    int flags = O_RDONLY;
+#ifdef O_DIRECT
+    if (direct) {flags |= O_DIRECT;}
+#else
+    if (direct) {
+        printf("O_DIRECT is not available on this platform.\n");
+        return false;
+    }
+#endif
+    fFd = open(fname, flags);
+    if (fFd < 0) {
+        printf("Failed to open %s%s: %s\n", fname, direct ? " with O_DIRECT" : "", strerror(errno));
+        return false;
+    }
+    fDirect = direct;
+    return true;
+}
+
+bool RawFileReader::Read(char *dst, Long64_t offset, size_t len) {
+    if (!fDirect) {
+        return pread(fFd, dst, len, offset) == static_cast<ssize_t>(len);
+    }
+    Long64_t start = offset & ~static_cast<Long64_t>(kDirectAlignment - 1);
+    size_t span = (offset - start + len + kDirectAlignment - 1) & ~(kDirectAlignment - 1);
+    if (span > fBounceSize) {
+        free(fBounce);
+        fBounce = nullptr;
+        fBounceSize = 0;
+        if (posix_memalign(reinterpret_cast<void**>(&fBounce), kDirectAlignment, span)) {return false;}
+        fBounceSize = span;
+    }
+    // The aligned span may run past the end of the file; only the requested bytes must be there.
+    ssize_t nread = pread(fFd, fBounce, span, start);
+    if (nread < static_cast<ssize_t>(offset - start + len)) {return false;}
+    memcpy(dst, fBounce + (offset - start), len);
+    return true;
+}
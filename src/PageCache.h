@@ -0,0 +1,50 @@
+#ifndef BULKAPI_PAGE_CACHE_H
+#define BULKAPI_PAGE_CACHE_H
+
+#include <stddef.h>
+
+#include "Rtypes.h"
+
+/// The state of the benchmark file in the page cache when a read mode starts.
+enum class PageCache {
+    kAsIs,  // Whatever earlier runs left behind.
+    kCold,  // Evicted with POSIX_FADV_DONTNEED.
+    kWarm   // Read once in full beforehand.
+};
+
+bool ParsePageCache(const char *name, PageCache &state);
+const char *GetPageCacheName(PageCache state);
+
+/**
+ * Put `fname` into the requested page cache state and report the fraction
+ * of its pages resident afterwards, so a cold run can show the eviction
+ * actually happened (it does not for dirty pages on some filesystems, or
+ * for files held by other mappings).  Returns false on error.
+ */
+bool PreparePageCache(const char *fname, PageCache state, double &resident);
+
+/**
+ * Positional reads of a file, optionally with O_DIRECT so they bypass the
+ * page cache altogether.  Direct reads go through an aligned bounce buffer,
+ * so callers can ask for any offset and length.  Not thread-safe.
+ */
+class RawFileReader {
+public:
+    RawFileReader() = default;
+    ~RawFileReader();
+    RawFileReader(const RawFileReader &) = delete;
+    RawFileReader &operator=(const RawFileReader &) = delete;
+
+    bool Open(const char *fname, bool direct);
+
+    /// Read exactly `len` bytes at `offset`; false on error or a short read.
+    bool Read(char *dst, Long64_t offset, size_t len);
+
+private:
+    int fFd{-1};
+    bool fDirect{false};
+    char *fBounce{nullptr};
+    size_t fBounceSize{0};
+};
+
+#endif  // BULKAPI_PAGE_CACHE_H
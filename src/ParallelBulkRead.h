@@ -0,0 +1,17 @@
+#ifndef BULKAPI_PARALLEL_BULK_READ_H
+#define BULKAPI_PARALLEL_BULK_READ_H
+
+#include "BenchmarkContext.h"
+
+/**
+ * Bulk-read 'myFloat' with ctx.threads worker threads.
+ *
+ * The entries are split into basket-aligned ranges, one per worker.  Every
+ * worker opens its own TFile, set up with ctx's TTreeCache settings, and
+ * owns its own TBufferFile, so the only state the workers share is whatever
+ * ROOT itself keeps global.  The timer starts once all workers have opened
+ * the file and stops when the last one finishes.
+ */
+Long64_t ReadBulkParallel(BenchmarkContext &ctx);
+
+#endif  // BULKAPI_PARALLEL_BULK_READ_H
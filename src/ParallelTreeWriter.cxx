@@ -0,0 +1,127 @@
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+#include "TDirectory.h"
+#include "TMemFile.h"
+#include "TROOT.h"
+#include "TTree.h"
+
+#include "ParallelTreeWriter.h"
+
+ParallelTreeWriter::ParallelTreeWriter(TDirectory *output, int compression, int workers, Long64_t chunk_entries)
+    : fOutput(output), fCompression(compression), fWorkers(std::max(workers, 1)),
+      fChunkEntries(std::max<Long64_t>(chunk_entries, 1)), fChunks(2 * fWorkers) {}
+
+ParallelTreeWriter::~ParallelTreeWriter() {
+    Stop();
+}
+
+void ParallelTreeWriter::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fStopping = true;
+    }
+    fCond.notify_all();
+    for (auto &worker : fWorkerThreads) {
+        if (worker.joinable()) {worker.join();}
+    }
+    fWorkerThreads.clear();
+}
+
+bool ParallelTreeWriter::FillChunk(Long64_t index, const char *name, Long64_t events, const ChunkFiller &filler,
+                                   Chunk &chunk) {
+    // Memory files are registered globally by name, so each needs a unique one.
+    std::string fname = "ParallelTreeWriter-" + std::to_string(reinterpret_cast<uintptr_t>(this)) + "-" +
+                        std::to_string(index) + ".root";
+    chunk.file.reset(new TMemFile(fname.c_str(), "RECREATE"));
+    if (fCompression >= 0) {chunk.file->SetCompressionSettings(fCompression);}
+    chunk.tree = new TTree(name, "");
+    chunk.tree->SetDirectory(chunk.file.get());
+    Long64_t first = index * fChunkEntries;
+    if (!filler(chunk.tree, first, std::min(fChunkEntries, events - first))) {return false;}
+    // Compress and write out the last, partly filled baskets as well.
+    if (chunk.tree->FlushBaskets() < 0) {return false;}
+    // The filler's variables are gone once it returns; nothing may write through their addresses again.
+    chunk.tree->ResetBranchAddresses();
+    return true;
+}
+
+void ParallelTreeWriter::Compress(const char *name, Long64_t events, const ChunkFiller &filler) {
+    double compress_seconds = 0;
+    while (true) {
+        Long64_t index;
+        {
+            std::unique_lock<std::mutex> lock(fMutex);
+            fCond.wait(lock, [this] {
+                return fStopping || fFailed || (fNextChunk >= fChunkCount) ||
+                       (fNextChunk < fMerged + static_cast<Long64_t>(fChunks.size()));
+            });
+            if (fStopping || fFailed || (fNextChunk >= fChunkCount)) {break;}
+            index = fNextChunk++;
+        }
+        Chunk &chunk = fChunks[index % fChunks.size()];
+        auto start = std::chrono::steady_clock::now();
+        bool ok = FillChunk(index, name, events, filler, chunk);
+        compress_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            if (ok) {
+                chunk.ready = true;
+            } else {
+                printf("Failed to fill chunk %lld.\n", index);
+                fFailed = true;
+            }
+        }
+        fCond.notify_all();
+    }
+    std::lock_guard<std::mutex> lock(fMutex);
+    fCompressSeconds += compress_seconds;
+}
+
+TTree *ParallelTreeWriter::Write(const char *name, Long64_t events, ChunkFiller filler) {
+    ROOT::EnableThreadSafety();
+    fChunkCount = (events + fChunkEntries - 1) / fChunkEntries;
+    for (int idx = 0; idx < fWorkers; idx++) {
+        fWorkerThreads.emplace_back(&ParallelTreeWriter::Compress, this, name, events, filler);
+    }
+    TTree *output = nullptr;
+    for (Long64_t index = 0; index < fChunkCount; index++) {
+        Chunk &chunk = fChunks[index % fChunks.size()];
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::unique_lock<std::mutex> lock(fMutex);
+            fCond.wait(lock, [&] {return fFailed || chunk.ready;});
+            if (fFailed) {break;}
+        }
+        auto ready = std::chrono::steady_clock::now();
+        fWaitSeconds += std::chrono::duration<double>(ready - start).count();
+        if (!output) {
+            // The first chunk defines the branch layout of the output tree.
+            fOutput->cd();
+            output = chunk.tree->CloneTree(0);
+            output->SetDirectory(fOutput);
+            output->ResetBranchAddresses();
+        }
+        Long64_t copied = output->CopyEntries(chunk.tree, -1, "fast");
+        chunk.tree = nullptr;
+        chunk.file.reset();
+        fMergeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - ready).count();
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            chunk.ready = false;
+            fMerged++;
+            if (copied < 0) {
+                printf("Failed to copy chunk %lld to the output tree.\n", index);
+                fFailed = true;
+            }
+        }
+        fCond.notify_all();
+    }
+    Stop();
+    return fFailed ? nullptr : output;
+}
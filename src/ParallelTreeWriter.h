@@ -0,0 +1,89 @@
+#ifndef BULKAPI_PARALLEL_TREE_WRITER_H
+#define BULKAPI_PARALLEL_TREE_WRITER_H
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Rtypes.h"
+
+class TDirectory;
+class TMemFile;
+class TTree;
+
+/**
+ * Creates the branches of a fresh tree and fills it with entries
+ * [first, first + count).  Returns false on error.  Branch addresses may
+ * point at the filler's locals; they are reset once it returns.
+ */
+typedef std::function<bool(TTree *tree, Long64_t first, Long64_t count)> ChunkFiller;
+
+/**
+ * Writes a tree with its basket compression spread over a pool of workers.
+ *
+ * The entries are split into chunks of `chunk_entries`.  Each worker fills
+ * a chunk into a tree of its own in a TMemFile, so its baskets are
+ * compressed on that worker, and the calling thread appends the finished
+ * chunks to the output tree in order with a fast CopyEntries, which copies
+ * the compressed baskets without touching them.  At most two chunks per
+ * worker are in flight.
+ *
+ * Every chunk ends on a basket boundary, so the output has up to one
+ * partly filled basket per chunk; chunks spanning many baskets keep that
+ * overhead small.
+ */
+class ParallelTreeWriter {
+public:
+    ParallelTreeWriter(TDirectory *output, int compression, int workers, Long64_t chunk_entries);
+    ~ParallelTreeWriter();
+
+    /**
+     * Fill `events` entries through `filler` into a tree called `name` in
+     * the output directory.  Returns the tree, owned by the directory, or
+     * nullptr on error.
+     */
+    TTree *Write(const char *name, Long64_t events, ChunkFiller filler);
+
+    Long64_t GetChunks() const {return fChunkCount;}
+    /// Seconds spent filling and compressing chunks, summed over all workers.
+    double GetCompressSeconds() const {return fCompressSeconds;}
+    /// Seconds the calling thread spent copying finished chunks to the output.
+    double GetMergeSeconds() const {return fMergeSeconds;}
+    /// Seconds the calling thread spent waiting for the next chunk.
+    double GetWaitSeconds() const {return fWaitSeconds;}
+
+private:
+    struct Chunk {
+        std::unique_ptr<TMemFile> file;
+        TTree *tree{nullptr};
+        bool ready{false};
+    };
+
+    void Compress(const char *name, Long64_t events, const ChunkFiller &filler);
+    bool FillChunk(Long64_t index, const char *name, Long64_t events, const ChunkFiller &filler, Chunk &chunk);
+    void Stop();
+
+    TDirectory *fOutput;
+    int fCompression;
+    int fWorkers;
+    Long64_t fChunkEntries;
+
+    std::vector<Chunk> fChunks;   // Ring of in-flight chunks; chunk i uses slot i % size.
+    std::mutex fMutex;
+    std::condition_variable fCond;
+    Long64_t fChunkCount{0};
+    Long64_t fNextChunk{0};       // Next chunk for a worker to fill.
+    Long64_t fMerged{0};          // Chunks already copied to the output.
+    bool fFailed{false};
+    bool fStopping{false};
+    std::vector<std::thread> fWorkerThreads;
+
+    double fCompressSeconds{0};
+    double fMergeSeconds{0};
+    double fWaitSeconds{0};
+};
+
+#endif  // BULKAPI_PARALLEL_TREE_WRITER_H
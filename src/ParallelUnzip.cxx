@@ -0,0 +1,256 @@
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "RZip.h"
+#include "TBranch.h"
+#include "TTree.h"
+
+#include "BasketUtils.h"
+#include "ByteSwap.h"
+#include "ParallelUnzip.h"
+
+// Every basket starts with a TKey header: Nbytes (4 bytes), Version (2),
+// ObjLen (4), Datime (4), KeyLen (2), ...; the payload follows after KeyLen
+// bytes.  All fields are big-endian.  A compressed payload is a sequence of
+// blocks, each with a 9-byte header giving its compressed and output sizes.
+static const Int_t kKeyHeaderMin = 16;
+static const Int_t kZipHeaderSize = 9;
+
+static int32_t ReadInt32(const char *ptr) {
+    uint32_t raw;
+    memcpy(&raw, ptr, 4);
+    return static_cast<int32_t>(__builtin_bswap32(raw));
+}
+
+static int16_t ReadInt16(const char *ptr) {
+    uint16_t raw;
+    memcpy(&raw, ptr, 2);
+    return static_cast<int16_t>(__builtin_bswap16(raw));
+}
+
+ParallelUnzipReader::ParallelUnzipReader(const char *fname, TBranch *branch, size_t entry_size, int workers, int depth,
+                                         bool direct)
+    : fFileName(fname), fBranch(branch), fEntrySize(entry_size), fWorkers(std::max(workers, 1)), fDirect(direct),
+      fSlots(std::max(depth, fWorkers + 1)) {}
+
+ParallelUnzipReader::~ParallelUnzipReader() {
+    Stop();
+}
+
+bool ParallelUnzipReader::Start(Long64_t events) {
+    if (!fFile.Open(fFileName.c_str(), fDirect)) {return false;}
+    fBoundaries = GetBasketBoundaries(fBranch);
+    fEvents = std::min(events, fBoundaries.back());
+    while ((fBasketCount + 1 < static_cast<Int_t>(fBoundaries.size())) && (fBoundaries[fBasketCount] < fEvents)) {
+        fBasketCount++;
+    }
+    if (fBasketCount > fBranch->GetWriteBasket()) {
+        printf("Branch '%s' has baskets that were never written to the file.\n", fBranch->GetName());
+        return false;
+    }
+    for (Int_t basket = 0; basket < fBasketCount; basket++) {
+        fSeeks.push_back(fBranch->GetBasketSeek(basket));
+        fBytes.push_back(fBranch->GetBasketBytes()[basket]);
+    }
+    fIOThread = std::thread(&ParallelUnzipReader::ReadBaskets, this);
+    for (int idx = 0; idx < fWorkers; idx++) {
+        fWorkerThreads.emplace_back(&ParallelUnzipReader::Decompress, this);
+    }
+    return true;
+}
+
+void ParallelUnzipReader::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fStopping = true;
+    }
+    fCond.notify_all();
+    if (fIOThread.joinable()) {fIOThread.join();}
+    for (auto &worker : fWorkerThreads) {
+        if (worker.joinable()) {worker.join();}
+    }
+}
+
+void ParallelUnzipReader::Fail() {
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fFailed = true;
+    }
+    fCond.notify_all();
+}
+
+void ParallelUnzipReader::ReadBaskets() {
+    double io_seconds = 0;
+    Long64_t zip_bytes = 0;
+    for (Int_t basket = 0; basket < fBasketCount; basket++) {
+        Slot &slot = fSlots[basket % fSlots.size()];
+        {
+            std::unique_lock<std::mutex> lock(fMutex);
+            fCond.wait(lock, [&] {return fStopping || fFailed || (slot.state == SlotState::kFree);});
+            if (fStopping || fFailed) {break;}
+        }
+        // The slot is free, so nobody else touches it until it is queued.
+        slot.raw.resize(fBytes[basket]);
+        auto start = std::chrono::steady_clock::now();
+        bool ok = fFile.Read(slot.raw.data(), fSeeks[basket], fBytes[basket]);
+        io_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (R__unlikely(!ok)) {
+            printf("Failed to read basket %d of branch '%s'.\n", basket, fBranch->GetName());
+            Fail();
+            break;
+        }
+        zip_bytes += fBytes[basket];
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            slot.state = SlotState::kQueued;
+            fQueue.push_back(basket);
+        }
+        fCond.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fReadDone = true;
+        fIOSeconds = io_seconds;
+        fZipBytes = zip_bytes;
+    }
+    fCond.notify_all();
+}
+
+void ParallelUnzipReader::Decompress() {
+    double unzip_seconds = 0;
+    while (true) {
+        Int_t basket;
+        {
+            std::unique_lock<std::mutex> lock(fMutex);
+            fCond.wait(lock, [this] {return fStopping || fFailed || fReadDone || !fQueue.empty();});
+            if (fStopping || fFailed || fQueue.empty()) {break;}
+            basket = fQueue.front();
+            fQueue.pop_front();
+        }
+        Slot &slot = fSlots[basket % fSlots.size()];
+        auto start = std::chrono::steady_clock::now();
+        bool ok = Unzip(basket, slot);
+        unzip_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!ok) {
+            Fail();
+            break;
+        }
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            slot.state = SlotState::kReady;
+        }
+        fCond.notify_all();
+    }
+    std::lock_guard<std::mutex> lock(fMutex);
+    fUnzipSeconds += unzip_seconds;
+}
+
+bool ParallelUnzipReader::Unzip(Int_t basket, Slot &slot) {
+    const char *raw = slot.raw.data();
+    Int_t nbytes = slot.raw.size();
+    Int_t keylen = nbytes >= kKeyHeaderMin ? ReadInt16(raw + 14) : 0;
+    Int_t objlen = nbytes >= kKeyHeaderMin ? ReadInt32(raw + 6) : 0;
+    Long64_t count = fBoundaries[basket + 1] - fBoundaries[basket];
+    if ((keylen < kKeyHeaderMin) || (keylen > nbytes) || (objlen < static_cast<Long64_t>(count * fEntrySize))) {
+        printf("Basket %d of branch '%s' has a malformed key header.\n", basket, fBranch->GetName());
+        return false;
+    }
+    slot.values.resize(objlen);
+    if (nbytes - keylen == objlen) {
+        memcpy(slot.values.data(), raw + keylen, objlen);
+    } else {
+        UChar_t *src = reinterpret_cast<UChar_t*>(slot.raw.data() + keylen);
+        Int_t remaining = nbytes - keylen;
+        Int_t produced = 0;
+        while (produced < objlen) {
+            Int_t nin, nbuf, nout = 0;
+            if ((remaining < kZipHeaderSize) || R__unzip_header(&nin, src, &nbuf) ||
+                (nin > remaining) || (nbuf > objlen - produced)) {
+                printf("Basket %d of branch '%s' has a malformed compression header.\n", basket, fBranch->GetName());
+                return false;
+            }
+            R__unzip(&nin, src, &nbuf, reinterpret_cast<UChar_t*>(slot.values.data() + produced), &nout);
+            if (R__unlikely(!nout)) {
+                printf("Failed to decompress basket %d of branch '%s'.\n", basket, fBranch->GetName());
+                return false;
+            }
+            src += nin;
+            remaining -= nin;
+            produced += nout;
+        }
+    }
+    if (fEntrySize == 8) {
+        DecodeBigEndian64(slot.values.data(), slot.values.data(), count);
+    } else {
+        DecodeBigEndian32(slot.values.data(), slot.values.data(), count);
+    }
+    return true;
+}
+
+Long64_t ParallelUnzipReader::Next(const char *&data, Long64_t &first_entry) {
+    auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(fMutex);
+    if (fNext > 0) {
+        Slot &held = fSlots[(fNext - 1) % fSlots.size()];
+        if (held.state == SlotState::kHeld) {
+            held.state = SlotState::kFree;
+            fCond.notify_all();
+        }
+    }
+    if (fFailed) {return -1;}
+    if (fNext >= fBasketCount) {return 0;}
+    Slot &slot = fSlots[fNext % fSlots.size()];
+    fCond.wait(lock, [&] {return fFailed || (slot.state == SlotState::kReady);});
+    fWaitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (fFailed) {return -1;}
+    slot.state = SlotState::kHeld;
+    data = slot.values.data();
+    first_entry = fBoundaries[fNext];
+    Long64_t count = std::min(fBoundaries[fNext + 1], fEvents) - first_entry;
+    fNext++;
+    return count;
+}
+
+Long64_t ReadParallelUnzip(BenchmarkContext &ctx) {
+    TBranch *branchF = ctx.tree->GetBranch("myFloat");
+    if (!branchF) {
+        printf("Unable to find branch 'myFloat' in tree 'T'\n");
+        return -1;
+    }
+    // Enough baskets in flight to keep every worker busy while the consumer holds one.
+    int depth = std::max(ctx.prefetch_depth, 2 * ctx.threads);
+    ParallelUnzipReader reader(ctx.fname, branchF, sizeof(float), ctx.threads, depth, ctx.direct_io);
+    Long64_t events = std::min(ctx.events, ctx.tree->GetEntries());
+    ctx.StartTimer();
+    if (!reader.Start(events)) {return -1;}
+    Long64_t evt_idx = 0;
+    const char *data;
+    Long64_t first;
+    Long64_t count;
+    while ((count = reader.Next(data, first)) > 0) {
+        const float *entry = reinterpret_cast<const float*>(data);
+        for (Long64_t idx=0; idx<count; idx++) {
+            Long64_t evt = first + idx;
+            if (R__unlikely((evt < 16000000) && (entry[idx] != static_cast<float>(evt + 2)))) {
+                printf("Incorrect value on myFloat branch: %f (event %lld)\n", entry[idx], evt);
+                return -1;
+            }
+        }
+        evt_idx += count;
+    }
+    ctx.StopTimer();
+    if (count < 0) {return -1;}
+    ctx.bytes = evt_idx * sizeof(float);
+    ctx.AddMetric("workers", ctx.threads);
+    ctx.AddMetric("baskets", reader.GetBaskets());
+    ctx.AddMetric("zip_bytes", reader.GetZipBytes());
+    ctx.AddMetric("io_s", reader.GetIOSeconds());
+    ctx.AddMetric("unzip_s", reader.GetUnzipSeconds());
+    ctx.AddMetric("consumer_wait_s", reader.GetWaitSeconds());
+    return evt_idx;
+}
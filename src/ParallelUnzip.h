@@ -0,0 +1,107 @@
+#ifndef BULKAPI_PARALLEL_UNZIP_H
+#define BULKAPI_PARALLEL_UNZIP_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Rtypes.h"
+
+#include "BenchmarkContext.h"
+#include "PageCache.h"
+
+class TBranch;
+
+/**
+ * Reads one branch of fixed-size values with its decompression spread over
+ * a pool of workers.
+ *
+ * An I/O thread reads the compressed bytes of basket after basket straight
+ * from the file with pread() (through O_DIRECT if `direct` is set), a pool
+ * of `workers` threads decompresses them with R__unzip and decodes the
+ * values to native order, and Next() hands them to the consumer strictly in
+ * basket order, as GetEntriesFast would.  Up to `depth` baskets are in
+ * flight at once; the consumer owns the basket returned by Next() until its
+ * next call to Next().
+ *
+ * All basket metadata is copied from the branch in Start(), so the threads
+ * never touch ROOT objects.
+ */
+class ParallelUnzipReader {
+public:
+    ParallelUnzipReader(const char *fname, TBranch *branch, size_t entry_size, int workers, int depth,
+                        bool direct = false);
+    ~ParallelUnzipReader();
+
+    /// Start reading the baskets covering the first `events` entries.  Returns false on error.
+    bool Start(Long64_t events);
+
+    /**
+     * Block until the next basket is decoded.  Returns the number of entries
+     * in it (0 once the range is exhausted, -1 on an error) and points
+     * `data` at the first of them.
+     */
+    Long64_t Next(const char *&data, Long64_t &first_entry);
+
+    Long64_t GetBaskets() const {return fBasketCount;}
+    Long64_t GetZipBytes() const {return fZipBytes;}
+    /// Seconds the I/O thread spent in pread.
+    double GetIOSeconds() const {return fIOSeconds;}
+    /// Seconds spent decompressing and decoding, summed over all workers.
+    double GetUnzipSeconds() const {return fUnzipSeconds;}
+    /// Seconds the consumer spent blocked in Next().
+    double GetWaitSeconds() const {return fWaitSeconds;}
+
+private:
+    enum class SlotState {kFree, kQueued, kReady, kHeld};
+
+    struct Slot {
+        std::vector<char> raw;
+        std::vector<char> values;
+        SlotState state{SlotState::kFree};
+    };
+
+    void ReadBaskets();
+    void Decompress();
+    bool Unzip(Int_t basket, Slot &slot);
+    void Fail();
+    void Stop();
+
+    std::string fFileName;
+    TBranch *fBranch;
+    size_t fEntrySize;
+    int fWorkers;
+    bool fDirect;
+    RawFileReader fFile;
+
+    // Copied from the branch in Start().
+    std::vector<Long64_t> fBoundaries;
+    std::vector<Long64_t> fSeeks;
+    std::vector<Int_t> fBytes;
+    Int_t fBasketCount{0};
+    Long64_t fEvents{0};
+
+    std::vector<Slot> fSlots;
+    std::mutex fMutex;
+    std::condition_variable fCond;
+    std::deque<Int_t> fQueue;   // Baskets read but not yet decompressed.
+    Int_t fNext{0};             // Next basket for the consumer.
+    bool fReadDone{false};
+    bool fFailed{false};
+    bool fStopping{false};
+    std::thread fIOThread;
+    std::vector<std::thread> fWorkerThreads;
+
+    Long64_t fZipBytes{0};
+    double fIOSeconds{0};
+    double fUnzipSeconds{0};
+    double fWaitSeconds{0};
+};
+
+/// Read 'myFloat' through a ParallelUnzipReader with ctx.threads workers.
+Long64_t ReadParallelUnzip(BenchmarkContext &ctx);
+
+#endif  // BULKAPI_PARALLEL_UNZIP_H
@@ -0,0 +1,107 @@
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include "PerfCounters.h"
+
+#ifdef __linux__
+
+namespace {
+
+struct CounterSpec {
+    const char *name;
+    uint32_t type;
+    uint64_t config;
+};
+
+constexpr uint64_t CacheConfig(uint64_t cache, uint64_t op, uint64_t result) {
+    return cache | (op << 8) | (result << 16);
+}
+
+const CounterSpec kCounterSpecs[] = {
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"l1d_misses", PERF_TYPE_HW_CACHE,
+     CacheConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {"llc_misses", PERF_TYPE_HW_CACHE,
+     CacheConfig(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {"dtlb_misses", PERF_TYPE_HW_CACHE,
+     CacheConfig(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+};
+
+int OpenCounter(const CounterSpec &spec) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = spec.type;
+    attr.config = spec.config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+}  // namespace
+
+PerfCounters::PerfCounters() {
+    for (const auto &spec : kCounterSpecs) {
+        int fd = OpenCounter(spec);
+        if (fd < 0) {
+            fUnavailable.push_back(spec.name);
+            continue;
+        }
+        fCounters.push_back({spec.name, fd, 0});
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (const auto &counter : fCounters) {close(counter.fd);}
+}
+
+void PerfCounters::Start() {
+    for (const auto &counter : fCounters) {
+        ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void PerfCounters::Stop() {
+    for (const auto &counter : fCounters) {ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);}
+    for (auto &counter : fCounters) {
+        uint64_t values[3] = {0, 0, 0};  // value, time enabled, time running
+        counter.count = 0;
+        if (read(counter.fd, values, sizeof(values)) != sizeof(values)) {continue;}
+        // Scale up to compensate for time the counter spent multiplexed out.
+        counter.count = values[2] ? static_cast<double>(values[0]) * values[1] / values[2] : 0;
+    }
+}
+
+#else  // !__linux__
+
+PerfCounters::PerfCounters() {
+    fUnavailable = {"cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses", "dtlb_misses"};
+}
+
+PerfCounters::~PerfCounters() {}
+
+void PerfCounters::Start() {}
+
+void PerfCounters::Stop() {}
+
+#endif  // __linux__
+
+std::vector<std::pair<std::string, double>> PerfCounters::GetCounts() const {
+    std::vector<std::pair<std::string, double>> counts;
+    for (const auto &counter : fCounters) {counts.emplace_back(counter.name, counter.count);}
+    return counts;
+}
@@ -0,0 +1,50 @@
+#ifndef BULKAPI_PERF_COUNTERS_H
+#define BULKAPI_PERF_COUNTERS_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Hardware performance counters read through perf_event_open(2) around a
+ * timed region: cycles, instructions, L1D and last-level cache misses,
+ * branch misses and dTLB misses.
+ *
+ * Each counter is opened on its own, so one the CPU or kernel does not
+ * offer (or that perf_event_paranoid forbids) is simply left out rather
+ * than disabling the rest.  Counts are user-space only and are scaled up
+ * when the kernel had to multiplex them.  Threads created after the
+ * counters are opened are counted too, once they have exited.
+ */
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    /// False if not a single counter could be opened.
+    bool IsAvailable() const {return !fCounters.empty();}
+
+    /// Names of the counters that could not be opened.
+    const std::vector<std::string> &GetUnavailable() const {return fUnavailable;}
+
+    /// Zero and enable every counter.
+    void Start();
+    /// Disable every counter and latch the counts.
+    void Stop();
+
+    /// (name, count) for each available counter, as of the last Stop().
+    std::vector<std::pair<std::string, double>> GetCounts() const;
+
+private:
+    struct Counter {
+        std::string name;
+        int fd;
+        double count;
+    };
+    std::vector<Counter> fCounters;
+    std::vector<std::string> fUnavailable;
+};
+
+#endif  // BULKAPI_PERF_COUNTERS_H
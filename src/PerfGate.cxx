@@ -0,0 +1,319 @@
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Performance regression gate for CTest.
+ *
+ * Runs a benchmark command several times, takes the time it reports on its
+ * "Total elapsed time (seconds) for ...: X" line (printed with microsecond
+ * resolution, so the runs actually vary), and compares the runs
+ * with a baseline entry from a committed file.  The check fails only if the
+ * new runs are slower than the baseline plus the entry's tolerance with
+ * statistical significance (a one-sided Welch t-test), so ordinary noise
+ * does not fail the build.
+ *
+ * The baseline file has one line per entry:
+ *
+ *     name tolerance runs mean stddev
+ *
+ * with the tolerance a fraction (0.1 allows a 10% slowdown) and times in
+ * seconds; '#' starts a comment.  With --update, or PERF_GATE_UPDATE=1 in
+ * the environment, the measured runs replace the entry instead, keeping its
+ * tolerance.  A command with no entry is reported as skipped until one is
+ * recorded; with --require-baseline (or PERF_GATE_REQUIRE_BASELINE=1), as on
+ * a reference machine whose baselines are complete, it fails instead.
+ *
+ * Exit codes: 0 pass, 1 significant slowdown, 2 error, 3 no baseline with
+ * --require-baseline, 77 no baseline yet (reported by CTest as skipped).
+ */
+
+static const int kExitSlower = 1;
+static const int kExitError = 2;
+static const int kExitNoBaseline = 3;
+static const int kExitSkipped = 77;
+static const char kTimePrefix[] = "Total elapsed time (seconds)";
+
+struct BaselineEntry {
+    std::string name;
+    double tolerance;
+    long runs;
+    double mean;
+    double stddev;
+};
+
+static void Usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [options] -- command [args...]\n", prog);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -n, --name NAME         Baseline entry for this command (required).\n");
+    fprintf(stderr, "  -b, --baseline FILE     Baseline file (required).\n");
+    fprintf(stderr, "  -r, --repetitions N     Timed runs of the command (default: 5).\n");
+    fprintf(stderr, "  -w, --warmup N          Untimed runs first (default: 1).\n");
+    fprintf(stderr, "  -t, --tolerance F       Allowed slowdown for new entries, as a fraction (default: 0.1).\n");
+    fprintf(stderr, "  -a, --alpha P           Significance level of the t-test (default: 0.01).\n");
+    fprintf(stderr, "  -u, --update            Record the runs as the new baseline instead of comparing.\n");
+    fprintf(stderr, "  -R, --require-baseline  Fail instead of skipping when the baseline has no entry.\n");
+}
+
+/// Continued fraction for the regularized incomplete beta function (modified Lentz).
+static double BetaContinuedFraction(double a, double b, double x) {
+    const double tiny = 1e-300;
+    double c = 1, d = 1 - (a + b) * x / (a + 1);
+    d = 1 / (std::fabs(d) < tiny ? tiny : d);
+    double result = d;
+    for (int m = 1; m <= 300; m++) {
+        for (int step = 0; step < 2; step++) {
+            double num = step ? -(a + m) * (a + b + m) * x / ((a + 2*m) * (a + 2*m + 1))
+                              : m * (b - m) * x / ((a + 2*m - 1) * (a + 2*m));
+            d = 1 + num * d;
+            d = 1 / (std::fabs(d) < tiny ? tiny : d);
+            c = 1 + num / c;
+            c = std::fabs(c) < tiny ? tiny : c;
+            result *= c * d;
+        }
+        if (std::fabs(c * d - 1) < 1e-12) {break;}
+    }
+    return result;
+}
+
+static double RegularizedBeta(double a, double b, double x) {
+    if (x <= 0) {return 0;}
+    if (x >= 1) {return 1;}
+    double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) + b * std::log1p(-x));
+    if (x < (a + 1) / (a + b + 2)) {return front * BetaContinuedFraction(a, b, x) / a;}
+    return 1 - front * BetaContinuedFraction(b, a, 1 - x) / b;
+}
+
+/// P(T > t) for Student's t with `df` degrees of freedom.
+static double StudentUpperTail(double t, double df) {
+    double tail = 0.5 * RegularizedBeta(df / 2, 0.5, df / (df + t * t));
+    return t > 0 ? tail : 1 - tail;
+}
+
+static bool ReadBaselines(const char *fname, std::vector<BaselineEntry> &entries) {
+    std::ifstream in(fname);
+    if (!in) {return errno == ENOENT;}
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) {line.resize(hash);}
+        std::istringstream ss(line);
+        BaselineEntry entry;
+        if (!(ss >> entry.name)) {continue;}
+        if (!(ss >> entry.tolerance >> entry.runs >> entry.mean >> entry.stddev)) {
+            fprintf(stderr, "Malformed baseline line in %s: %s\n", fname, line.c_str());
+            return false;
+        }
+        entries.push_back(entry);
+    }
+    return true;
+}
+
+/// Rewrite the file with `entry` replaced or appended, keeping comments and other entries.
+static bool UpdateBaseline(const char *fname, const BaselineEntry &entry) {
+    std::vector<std::string> lines;
+    {
+        std::ifstream in(fname);
+        std::string line;
+        while (std::getline(in, line)) {lines.push_back(line);}
+    }
+    char buf[512];
+    snprintf(buf, sizeof(buf), "%-40s %6.3f %4ld %12.6f %12.6f", entry.name.c_str(), entry.tolerance, entry.runs,
+             entry.mean, entry.stddev);
+    bool replaced = false;
+    for (auto &line : lines) {
+        std::istringstream ss(line);
+        std::string name;
+        if ((ss >> name) && (name == entry.name)) {
+            line = buf;
+            replaced = true;
+        }
+    }
+    if (!replaced) {lines.push_back(buf);}
+    FILE *fp = fopen(fname, "w");
+    if (!fp) {
+        fprintf(stderr, "Failed to open baseline file %s: %s\n", fname, strerror(errno));
+        return false;
+    }
+    for (const auto &line : lines) {fprintf(fp, "%s\n", line.c_str());}
+    return fclose(fp) == 0;
+}
+
+static bool EnvironmentFlag(const char *name) {
+    const char *value = getenv(name);
+    return value && strcmp(value, "") && strcmp(value, "0");
+}
+
+/**
+ * Run the command once with its stdout captured, and return the time from
+ * its "Total elapsed time" line, or a negative value on failure.
+ */
+static double RunCommand(char **command) {
+    int fds[2];
+    if (pipe(fds)) {return -1;}
+    pid_t pid = fork();
+    if (pid < 0) {return -1;}
+    if (pid == 0) {
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        execvp(command[0], command);
+        fprintf(stderr, "Failed to run %s: %s\n", command[0], strerror(errno));
+        _exit(127);
+    }
+    close(fds[1]);
+    std::string output;
+    char buf[4096];
+    ssize_t nread;
+    while ((nread = read(fds[0], buf, sizeof(buf))) > 0) {output.append(buf, nread);}
+    close(fds[0]);
+    int status;
+    if ((waitpid(pid, &status, 0) != pid) || !WIFEXITED(status) || WEXITSTATUS(status)) {
+        fprintf(stderr, "%s failed; its output was:\n%s", command[0], output.c_str());
+        return -1;
+    }
+    size_t pos = output.rfind(kTimePrefix);
+    size_t colon = pos == std::string::npos ? pos : output.find(':', pos);
+    if (colon == std::string::npos) {
+        fprintf(stderr, "No '%s' line in the output of %s.\n", kTimePrefix, command[0]);
+        return -1;
+    }
+    return strtod(output.c_str() + colon + 1, nullptr);
+}
+
+int main(int argc, char *argv[]) {
+
+    // Handle all the argument parsing up front.
+    const char *name = nullptr;
+    const char *baseline = nullptr;
+    long repetitions = 5, warmup = 1;
+    double tolerance = 0.1, alpha = 0.01;
+    bool update = EnvironmentFlag("PERF_GATE_UPDATE");
+    bool require_baseline = EnvironmentFlag("PERF_GATE_REQUIRE_BASELINE");
+
+    static const struct option long_options[] = {
+        {"name", required_argument, nullptr, 'n'},
+        {"baseline", required_argument, nullptr, 'b'},
+        {"repetitions", required_argument, nullptr, 'r'},
+        {"warmup", required_argument, nullptr, 'w'},
+        {"tolerance", required_argument, nullptr, 't'},
+        {"alpha", required_argument, nullptr, 'a'},
+        {"update", no_argument, nullptr, 'u'},
+        {"require-baseline", no_argument, nullptr, 'R'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "+n:b:r:w:t:a:uRh", long_options, nullptr)) != -1) {
+        switch (opt) {
+        case 'n':
+            name = optarg;
+            break;
+        case 'b':
+            baseline = optarg;
+            break;
+        case 'r':
+            repetitions = strtol(optarg, nullptr, 10);
+            if (repetitions < 2) {
+                fprintf(stderr, "At least two repetitions are needed for the t-test.\n");
+                return kExitError;
+            }
+            break;
+        case 'w':
+            warmup = strtol(optarg, nullptr, 10);
+            break;
+        case 't':
+            tolerance = strtod(optarg, nullptr);
+            break;
+        case 'a':
+            alpha = strtod(optarg, nullptr);
+            break;
+        case 'u':
+            update = true;
+            break;
+        case 'R':
+            require_baseline = true;
+            break;
+        case 'h':
+            Usage(argv[0]);
+            return 0;
+        default:
+            Usage(argv[0]);
+            return kExitError;
+        }
+    }
+    if (!name || !baseline || (optind >= argc)) {
+        Usage(argv[0]);
+        return kExitError;
+    }
+    char **command = argv + optind;
+    // End arg parsing.
+
+    std::vector<double> times;
+    for (long rep = 0; rep < warmup + repetitions; rep++) {
+        double seconds = RunCommand(command);
+        if (seconds < 0) {return kExitError;}
+        if (rep >= warmup) {times.push_back(seconds);}
+    }
+    double mean = 0, var = 0;
+    for (double t : times) {mean += t;}
+    mean /= times.size();
+    for (double t : times) {var += (t - mean) * (t - mean);}
+    var /= times.size() - 1;
+
+    std::vector<BaselineEntry> entries;
+    if (!ReadBaselines(baseline, entries)) {return kExitError;}
+    const BaselineEntry *entry = nullptr;
+    for (const auto &candidate : entries) {
+        if (candidate.name == name) {entry = &candidate;}
+    }
+
+    if (update) {
+        BaselineEntry updated{name, entry ? entry->tolerance : tolerance, static_cast<long>(times.size()), mean,
+                              std::sqrt(var)};
+        if (!UpdateBaseline(baseline, updated)) {return kExitError;}
+        printf("%s: recorded baseline %.4f s +- %.4f s over %zu runs.\n", name, mean, std::sqrt(var), times.size());
+        return 0;
+    }
+    if (!entry) {
+        printf("%s: %.4f s +- %.4f s; no baseline in %s (record one with PERF_GATE_UPDATE=1).\n",
+               name, mean, std::sqrt(var), baseline);
+        return require_baseline ? kExitNoBaseline : kExitSkipped;
+    }
+
+    // H0: the new mean is at most the baseline mean plus the tolerance.
+    double scale = 1 + entry->tolerance;
+    double limit = entry->mean * scale;
+    double var_new = var / times.size();
+    double var_base = scale * scale * entry->stddev * entry->stddev / entry->runs;
+    double se = std::sqrt(var_new + var_base);
+    bool slower;
+    double t = 0, df = 0, p = 0;
+    if (se > 0) {
+        t = (mean - limit) / se;
+        // Welch-Satterthwaite degrees of freedom.
+        double denom = var_new * var_new / (times.size() - 1) + (entry->runs > 1 ? var_base * var_base / (entry->runs - 1) : 0);
+        df = denom > 0 ? (var_new + var_base) * (var_new + var_base) / denom : times.size() - 1;
+        p = StudentUpperTail(t, df);
+        slower = p < alpha;
+    } else {
+        // Timings too coarse to vary: compare the means directly.
+        slower = mean > limit;
+        p = slower ? 0 : 1;
+    }
+    printf("%s: %.4f s +- %.4f s (n=%zu) vs. baseline %.4f s +- %.4f s (n=%ld), %+.1f%%; "
+           "limit %.4f s, t=%.2f, df=%.1f, p=%.3g: %s\n",
+           name, mean, std::sqrt(var), times.size(), entry->mean, entry->stddev, entry->runs,
+           entry->mean > 0 ? 100 * (mean / entry->mean - 1) : 0, limit, t, df, p, slower ? "SLOWER" : "ok");
+    return slower ? kExitSlower : 0;
+}
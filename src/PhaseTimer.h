@@ -0,0 +1,38 @@
+#ifndef BULKAPI_PHASE_TIMER_H
+#define BULKAPI_PHASE_TIMER_H
+
+#include <chrono>
+
+#include "Rtypes.h"
+
+/**
+ * Accumulates the time spent in one phase of a read loop (fetching a basket,
+ * byte-swapping it, running the consumer over it) across many short
+ * intervals.  When disabled, Start() and Stop() do nothing, so a mode can
+ * keep the calls in its loop unconditionally.
+ */
+class PhaseTimer {
+public:
+    explicit PhaseTimer(bool enabled) : fEnabled(enabled) {}
+
+    void Start() {
+        if (fEnabled) {fStart = std::chrono::steady_clock::now();}
+    }
+
+    void Stop() {
+        if (!fEnabled) {return;}
+        fSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - fStart).count();
+        fIntervals++;
+    }
+
+    double GetSeconds() const {return fSeconds;}
+    Long64_t GetIntervals() const {return fIntervals;}
+
+private:
+    bool fEnabled;
+    std::chrono::steady_clock::time_point fStart;
+    double fSeconds{0};
+    Long64_t fIntervals{0};
+};
+
+#endif  // BULKAPI_PHASE_TIMER_H
@@ -0,0 +1,171 @@
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "TBranch.h"
+#include "TBufferFile.h"
+#include "TFile.h"
+#include "TROOT.h"
+#include "TTree.h"
+#include "ROOT/TBulkBranchRead.hxx"
+
+#include "PrefetchingBulkReader.h"
+
+struct PrefetchingBulkReader::Slot {
+    TBufferFile buf{TBuffer::kWrite, 32*1024};
+    Long64_t first{0};
+    Long64_t count{0};
+};
+
+PrefetchingBulkReader::PrefetchingBulkReader(const std::string &fname, const std::string &branch, int depth,
+                                             bool serialized)
+    : fFileName(fname), fBranchName(branch), fSerialized(serialized) {
+    // One extra slot for the basket the consumer is holding.
+    for (int idx = 0; idx < std::max(depth, 1) + 1; idx++) {
+        fSlots.emplace_back(new Slot());
+        fFree.push_back(fSlots.back().get());
+    }
+}
+
+PrefetchingBulkReader::~PrefetchingBulkReader() {
+    Stop();
+}
+
+void PrefetchingBulkReader::SetTreeCache(Long64_t bytes, int learn_entries, CacheBranches branches) {
+    fCacheBytes = bytes;
+    fCacheLearnEntries = learn_entries;
+    fCacheBranches = branches;
+}
+
+bool PrefetchingBulkReader::Open() {
+    ROOT::EnableThreadSafety();
+    fFile.reset(TFile::Open(fFileName.c_str()));
+    if (!fFile || fFile->IsZombie()) {
+        printf("Prefetcher failed to open file %s.\n", fFileName.c_str());
+        return false;
+    }
+    TTree *tree = dynamic_cast<TTree*>(fFile->Get("T"));
+    fBranch = tree ? tree->GetBranch(fBranchName.c_str()) : nullptr;
+    if (!fBranch) {
+        printf("Prefetcher unable to find branch '%s' in tree 'T'\n", fBranchName.c_str());
+        return false;
+    }
+    return ConfigureTreeCache(tree, fCacheBytes, fCacheLearnEntries, fCacheBranches);
+}
+
+void PrefetchingBulkReader::Start(Long64_t first, Long64_t last) {
+    last = std::min(last, fBranch->GetEntries());
+    fProducer = std::thread(&PrefetchingBulkReader::Produce, this, first, last);
+}
+
+void PrefetchingBulkReader::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fStopping = true;
+    }
+    fCond.notify_all();
+    if (fProducer.joinable()) {fProducer.join();}
+}
+
+void PrefetchingBulkReader::Produce(Long64_t first, Long64_t last) {
+    Long64_t evt_idx = first;
+    double fetch_seconds = 0;
+    Long64_t baskets = 0;
+    bool failed = false;
+    while (evt_idx < last) {
+        Slot *slot;
+        {
+            std::unique_lock<std::mutex> lock(fMutex);
+            fCond.wait(lock, [this] {return fStopping || !fFree.empty();});
+            if (fStopping) {break;}
+            slot = fFree.front();
+            fFree.pop_front();
+        }
+        auto start = std::chrono::steady_clock::now();
+        Long64_t count = fSerialized ? fBranch->GetBulkRead().GetEntriesSerialized(evt_idx, slot->buf)
+                                     : fBranch->GetBulkRead().GetEntriesFast(evt_idx, slot->buf);
+        fetch_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (R__unlikely(count < 0)) {
+            printf("Failed to get entries via the bulk API for index %lld.\n", evt_idx);
+            failed = true;
+            break;
+        }
+        slot->first = evt_idx;
+        slot->count = std::min(count, last - evt_idx);
+        evt_idx += slot->count;
+        baskets++;
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            fReady.push_back(slot);
+        }
+        fCond.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fDone = true;
+        fFailed = failed;
+        fFetchSeconds = fetch_seconds;
+        fBaskets = baskets;
+    }
+    fCond.notify_all();
+}
+
+Long64_t PrefetchingBulkReader::Next(char *&data, Long64_t &first_entry) {
+    auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(fMutex);
+    if (fHeld) {
+        fFree.push_back(fHeld);
+        fHeld = nullptr;
+        fCond.notify_all();
+    }
+    fCond.wait(lock, [this] {return fDone || !fReady.empty();});
+    fWaitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (fReady.empty()) {
+        return fFailed ? -1 : 0;
+    }
+    fHeld = fReady.front();
+    fReady.pop_front();
+    data = fHeld->buf.GetCurrent();
+    first_entry = fHeld->first;
+    return fHeld->count;
+}
+
+Long64_t ReadBulkPrefetch(BenchmarkContext &ctx) {
+    PrefetchingBulkReader reader(ctx.GetInputName(), "myFloat", ctx.prefetch_depth);
+    reader.SetTreeCache(ctx.tree_cache_bytes, ctx.cache_learn_entries, ctx.cache_branches);
+    Long64_t events = std::min(ctx.events, ctx.tree->GetEntries());
+    if (!reader.Open()) {return -1;}
+    ctx.StartTimer();
+    reader.Start(0, events);
+    Long64_t evt_idx = 0;
+    char *data;
+    Long64_t first;
+    Long64_t count;
+    while ((count = reader.Next(data, first)) > 0) {
+        float *entry = reinterpret_cast<float*>(data);
+        for (Long64_t idx=0; idx<count; idx++) {
+            Long64_t evt = first + idx;
+            if (R__unlikely((evt < 16000000) && (entry[idx] != static_cast<float>(evt + 2)))) {
+                printf("Incorrect value on myFloat branch: %f (event %lld)\n", entry[idx], evt);
+                return -1;
+            }
+        }
+        evt_idx += count;
+    }
+    ctx.StopTimer();
+    if (count < 0) {return -1;}
+    ctx.bytes = evt_idx * sizeof(float);
+
+    // Whatever the producer spent fetching that the consumer did not wait for was overlapped with its work.
+    double fetch = reader.GetFetchSeconds(), wait = reader.GetWaitSeconds();
+    ctx.AddMetric("prefetch_depth", ctx.prefetch_depth);
+    ctx.AddMetric("extra_file_opens", 1);
+    ctx.AddMetric("baskets", reader.GetBasketsRead());
+    ctx.AddMetric("fetch_s", fetch);
+    ctx.AddMetric("consumer_wait_s", wait);
+    ctx.AddMetric("hidden_s", std::max(fetch - wait, 0.0));
+    ctx.AddMetric("hidden_fraction", fetch > 0 ? std::max(fetch - wait, 0.0) / fetch : 0);
+    return evt_idx;
+}
@@ -0,0 +1,88 @@
+#ifndef BULKAPI_PREFETCHING_BULK_READER_H
+#define BULKAPI_PREFETCHING_BULK_READER_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Rtypes.h"
+
+#include "BenchmarkContext.h"
+
+class TBranch;
+class TFile;
+
+/**
+ * Bulk reader that keeps up to `depth` baskets in flight.
+ *
+ * A producer thread with its own TFile calls GetEntriesFast (or
+ * GetEntriesSerialized) for basket k+1, k+2, ... while the consumer works on
+ * basket k.  Each basket lands in its own TBufferFile; the consumer owns the
+ * basket returned by Next() until its next call to Next().
+ */
+class PrefetchingBulkReader {
+public:
+    PrefetchingBulkReader(const std::string &fname, const std::string &branch, int depth, bool serialized = false);
+    ~PrefetchingBulkReader();
+
+    /// TTreeCache settings for the producer's tree, as for ConfigureTreeCache; call before Open().
+    void SetTreeCache(Long64_t bytes, int learn_entries, CacheBranches branches);
+
+    /// Open the producer's own copy of the file.  Returns false if the branch cannot be found.
+    bool Open();
+
+    /// Start the producer on entries [first, last).
+    void Start(Long64_t first, Long64_t last);
+
+    /**
+     * Block until the next basket is available.  Returns the number of
+     * entries in it (0 once the range is exhausted, -1 on a read error) and
+     * points `data` at the first of them.
+     */
+    Long64_t Next(char *&data, Long64_t &first_entry);
+
+    /// Seconds the producer spent inside the bulk API (I/O, decompression, deserialization).
+    double GetFetchSeconds() const {return fFetchSeconds;}
+    /// Seconds the consumer spent blocked in Next() waiting for the producer.
+    double GetWaitSeconds() const {return fWaitSeconds;}
+    Long64_t GetBasketsRead() const {return fBaskets;}
+
+private:
+    struct Slot;
+
+    void Produce(Long64_t first, Long64_t last);
+    void Stop();
+
+    std::string fFileName;
+    std::string fBranchName;
+    bool fSerialized;
+    Long64_t fCacheBytes{-1};
+    int fCacheLearnEntries{-1};
+    CacheBranches fCacheBranches{CacheBranches::kLearn};
+    std::unique_ptr<TFile> fFile;     // Used only by the producer once started.
+    TBranch *fBranch{nullptr};
+    std::vector<std::unique_ptr<Slot>> fSlots;
+
+    std::mutex fMutex;
+    std::condition_variable fCond;
+    std::deque<Slot*> fFree;
+    std::deque<Slot*> fReady;
+    Slot *fHeld{nullptr};
+    bool fDone{false};
+    bool fFailed{false};
+    bool fStopping{false};
+    std::thread fProducer;
+
+    double fFetchSeconds{0};
+    double fWaitSeconds{0};
+    Long64_t fBaskets{0};
+};
+
+/// Bulk-read 'myFloat' through a PrefetchingBulkReader with ctx.prefetch_depth buffers.
+Long64_t ReadBulkPrefetch(BenchmarkContext &ctx);
+
+#endif  // BULKAPI_PREFETCHING_BULK_READER_H
@@ -0,0 +1,696 @@
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <vector>
+
+#include "TBranch.h"
+#include "TBufferFile.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TTreeReader.h"
+#include "TTreeReaderValue.h"
+#include "ROOT/TTreeReaderFast.hxx"
+#include "ROOT/TTreeReaderValueFast.hxx"
+#include "ROOT/TBulkBranchRead.hxx"
+
+#include "AnalysisKernels.h"
+#include "BasketStatistics.h"
+#include "BasketUtils.h"
+#include "BasketCache.h"
+#include "BufferPool.h"
+#include "ByteSwap.h"
+#include "ColumnarFile.h"
+#include "MappedBranchReader.h"
+#include "PageCache.h"
+#include "ParallelBulkRead.h"
+#include "ParallelUnzip.h"
+#include "PhaseTimer.h"
+#include "PrefetchingBulkReader.h"
+#include "ReadModes.h"
+
+static TBranch *GetFloatBranch(BenchmarkContext &ctx) {
+    TBranch *branchF = ctx.tree->GetBranch("myFloat");
+    if (!branchF) {
+        printf("Unable to find branch 'myFloat' in tree 'T'\n");
+    }
+    return branchF;
+}
+
+/**
+ * Number of baskets needed to cover the first `events` entries, and the
+ * entries they hold.
+ */
+static Int_t CoveringBaskets(TBranch *branch, Long64_t events, Long64_t &entries) {
+    std::vector<Long64_t> boundaries = GetBasketBoundaries(branch);
+    Int_t baskets = 0;
+    while ((baskets + 1 < static_cast<Int_t>(boundaries.size())) && (boundaries[baskets] < events)) {baskets++;}
+    entries = std::min(events, boundaries[baskets]);
+    return baskets;
+}
+
+static void AddBasketCount(BenchmarkContext &ctx, Long64_t events) {
+    TBranch *branchF = ctx.tree->GetBranch("myFloat");
+    if (!branchF) {return;}
+    Long64_t entries;
+    ctx.AddMetric("baskets", CoveringBaskets(branchF, events, entries));
+}
+
+static Long64_t ReadStandard(BenchmarkContext &ctx) {
+    TTreeReader myReader(ctx.tree);
+    TTreeReaderValue<float> myF(myReader, "myFloat");
+    Long64_t idx = 0;
+    float idx_f = 1;
+    ctx.StartTimer();
+    while (myReader.Next()) {
+        if (R__unlikely(idx == ctx.events)) {break;}
+        idx_f++;
+        if (R__unlikely((idx < 16000000) && (*myF != idx_f))) {
+            printf("Incorrect value on myFloat branch: %f, expected %f (event %lld)\n", *myF, idx_f, idx);
+            return -1;
+        }
+        idx++;
+    }
+    ctx.StopTimer();
+    ctx.bytes = idx * sizeof(float);
+    if (ctx.phases) {AddBasketCount(ctx, idx);}
+    return idx;
+}
+
+static Long64_t ReadFastReader(BenchmarkContext &ctx) {
+    ROOT::Experimental::TTreeReaderFast myReader("T", ctx.file);
+    ROOT::Experimental::TTreeReaderValueFast<float> myF(myReader, "myFloat");
+    myReader.SetEntry(0);
+    if (ROOT::Internal::TTreeReaderValueBase::kSetupMatch != myF.GetSetupStatus()) {
+        printf("TTreeReaderValueFast<float> failed to initialize.  Status code: %d\n", myF.GetSetupStatus());
+        return -1;
+    }
+    if (myReader.GetEntryStatus() != TTreeReader::kEntryValid) {
+        printf("TTreeReaderFast failed to initialize.  Entry status: %d\n", myReader.GetEntryStatus());
+        return -1;
+    }
+    Long64_t idx = 0;
+    float idx_f = 1;
+    ctx.StartTimer();
+    for (auto it : myReader) {
+        if (R__unlikely(idx == ctx.events)) {break;}
+        idx_f++;
+        if (R__unlikely((idx < 16000000) && (*myF != idx_f))) {
+            printf("Incorrect value on myFloat branch: %f, expected %f (event %lld)\n", *myF, idx_f, idx);
+            return -1;
+        }
+        idx++;
+    }
+    ctx.StopTimer();
+    ctx.bytes = idx * sizeof(float);
+    if (ctx.phases) {AddBasketCount(ctx, idx);}
+    return idx;
+}
+
+/**
+ * With vectorize set, each basket is decoded with the runtime-selected SIMD
+ * kernel before the values are checked; otherwise the original per-element
+ * swap loop is used, for comparison.
+ */
+static Long64_t ReadBulkInlineImpl(BenchmarkContext &ctx, bool vectorize) {
+    TBufferFile branchbuf(TBuffer::kWrite, 32*1024);
+    TBranch *branchF = GetFloatBranch(ctx);
+    if (!branchF) {return -1;}
+    Long64_t events = std::min(ctx.events, ctx.tree->GetEntries());
+    float idx_f = 1;
+    Long64_t evt_idx = 0;
+    PhaseTimer fetch(ctx.phases), swap(ctx.phases && vectorize), consumer(ctx.phases);
+    ctx.StartTimer();
+    while (evt_idx < events) {
+        fetch.Start();
+        auto count = branchF->GetBulkRead().GetEntriesSerialized(evt_idx, branchbuf);
+        fetch.Stop();
+        if (R__unlikely(count < 0)) {
+            printf("Failed to get entries via the 'serialized' method for index %lld.\n", evt_idx);
+            return -1;
+        }
+        count = std::min<Long64_t>(count, events - evt_idx);
+        float *entry = reinterpret_cast<float*>(branchbuf.GetCurrent());
+        swap.Start();
+        if (vectorize) {DecodeBigEndianInPlace(entry, count);}
+        swap.Stop();
+        // Without vectorize the swap is interleaved with the checks and counts as consumer time.
+        consumer.Start();
+        for (Int_t idx=0; idx<count; idx++) {
+            idx_f++;
+            if (!vectorize) {
+                Int_t *buf = reinterpret_cast<Int_t*>(&entry[idx]);
+                *buf = __builtin_bswap32(*buf);
+            }
+
+            if (R__unlikely((evt_idx < 16000000) && (entry[idx] != idx_f))) {
+                printf("Incorrect value on myFloat branch: %f (event %lld)\n", entry[idx], evt_idx + idx);
+                return -1;
+            }
+        }
+        consumer.Stop();
+        evt_idx += count;
+    }
+    ctx.StopTimer();
+    ctx.bytes = evt_idx * sizeof(float);
+    if (ctx.phases) {
+        ctx.AddMetric("baskets", fetch.GetIntervals());
+        ctx.AddMetric("fetch_s", fetch.GetSeconds());
+        if (vectorize) {ctx.AddMetric("swap_s", swap.GetSeconds());}
+        ctx.AddMetric("consumer_s", consumer.GetSeconds());
+    }
+    return evt_idx;
+}
+
+static Long64_t ReadBulkInline(BenchmarkContext &ctx) {
+    return ReadBulkInlineImpl(ctx, true);
+}
+
+static Long64_t ReadBulkInlineScalar(BenchmarkContext &ctx) {
+    return ReadBulkInlineImpl(ctx, false);
+}
+
+/**
+ * The analysis for the float benchmark values, 2 up to events+1: the
+ * histogram spans that range and the default cut passes about half.
+ */
+static FloatAnalysis MakeAnalysis(const BenchmarkContext &ctx, Long64_t events) {
+    float cut = std::isnan(ctx.cut) ? events / 2.0 : ctx.cut;
+    return FloatAnalysis(ctx.kernel, cut, 0, events + 2, ctx.bins);
+}
+
+/// The kernel results, so runs of different modes can be cross-checked.
+static void AddAnalysisMetrics(BenchmarkContext &ctx, const FloatAnalysis &analysis) {
+    bool all = (ctx.kernel == AnalysisKernel::kAll);
+    if (all || ctx.kernel == AnalysisKernel::kSum) {ctx.AddMetric("sum", analysis.GetSum());}
+    if (all || ctx.kernel == AnalysisKernel::kMinMax) {
+        ctx.AddMetric("min", analysis.GetMin());
+        ctx.AddMetric("max", analysis.GetMax());
+    }
+    if (all || ctx.kernel == AnalysisKernel::kMoments) {
+        ctx.AddMetric("mean", analysis.GetMean());
+        ctx.AddMetric("variance", analysis.GetVariance());
+    }
+    if (all || ctx.kernel == AnalysisKernel::kCutCount) {ctx.AddMetric("passed", analysis.GetPassed());}
+    if (all || ctx.kernel == AnalysisKernel::kHistogram) {
+        std::vector<Long64_t> histogram = analysis.GetHistogram();
+        ctx.AddMetric("underflow", histogram.front());
+        ctx.AddMetric("overflow", histogram.back());
+    }
+}
+
+/// --kernel filled one entry at a time from TTreeReaderValue<float>.
+static Long64_t ReadStandardAnalysis(BenchmarkContext &ctx) {
+    TTreeReader myReader(ctx.tree);
+    TTreeReaderValue<float> myF(myReader, "myFloat");
+    Long64_t events = std::min(ctx.events, ctx.tree->GetEntries());
+    FloatAnalysis analysis = MakeAnalysis(ctx, events);
+    Long64_t idx = 0;
+    ctx.StartTimer();
+    while ((idx < events) && myReader.Next()) {
+        analysis.Fill(*myF);
+        idx++;
+    }
+    ctx.StopTimer();
+    ctx.bytes = idx * sizeof(float);
+    AddAnalysisMetrics(ctx, analysis);
+    if (ctx.phases) {AddBasketCount(ctx, idx);}
+    return idx;
+}
+
+/**
+ * --kernel over each basket after a SIMD decode, with either the scalar or
+ * the vector kernels, so the consumer cost can be compared on its own.
+ */
+static Long64_t ReadBulkAnalysisImpl(BenchmarkContext &ctx, bool simd) {
+    TBufferFile branchbuf(TBuffer::kWrite, 32*1024);
+    TBranch *branchF = GetFloatBranch(ctx);
+    if (!branchF) {return -1;}
+    Long64_t events = std::min(ctx.events, ctx.tree->GetEntries());
+    FloatAnalysis analysis = MakeAnalysis(ctx, events);
+    Long64_t evt_idx = 0;
+    PhaseTimer fetch(ctx.phases), swap(ctx.phases), consumer(ctx.phases);
+    ctx.StartTimer();
+    while (evt_idx < events) {
+        fetch.Start();
+        auto count = branchF->GetBulkRead().GetEntriesSerialized(evt_idx, branchbuf);
+        fetch.Stop();
+        if (R__unlikely(count < 0)) {
+            printf("Failed to get entries via the 'serialized' method for index %lld.\n", evt_idx);
+            return -1;
+        }
+        count = std::min<Long64_t>(count, events - evt_idx);
+        float *entry = reinterpret_cast<float*>(branchbuf.GetCurrent());
+        swap.Start();
+        DecodeBigEndianInPlace(entry, count);
+        swap.Stop();
+        consumer.Start();
+        analysis.FillBatch(entry, count, simd);
+        consumer.Stop();
+        evt_idx += count;
+    }
+    ctx.StopTimer();
+    ctx.bytes = evt_idx * sizeof(float);
+    AddAnalysisMetrics(ctx, analysis);
+    if (ctx.phases) {
+        ctx.AddMetric("baskets", fetch.GetIntervals());
+        ctx.AddMetric("fetch_s", fetch.GetSeconds());
+        ctx.AddMetric("swap_s", swap.GetSeconds());
+        ctx.AddMetric("consumer_s", consumer.GetSeconds());
+    }
+    return evt_idx;
+}
+
+static Long64_t ReadBulkAnalysis(BenchmarkContext &ctx) {
+    return ReadBulkAnalysisImpl(ctx, false);
+}
+
+static Long64_t ReadBulkAnalysisSimd(BenchmarkContext &ctx) {
+    return ReadBulkAnalysisImpl(ctx, true);
+}
+
+static Long64_t ReadBulk(BenchmarkContext &ctx) {
+    TBufferFile branchbuf(TBuffer::kWrite, 32*1024);
+    TBranch *branchF = GetFloatBranch(ctx);
+    if (!branchF) {return -1;}
+    Long64_t events = std::min(ctx.events, ctx.tree->GetEntries());
+    float idx_f = 1;
+    Long64_t evt_idx = 0;
+    PhaseTimer fetch(ctx.phases), consumer(ctx.phases);
+    ctx.StartTimer();
+    while (evt_idx < events) {
+        fetch.Start();
+        auto count = branchF->GetBulkRead().GetEntriesFast(evt_idx, branchbuf);
+        fetch.Stop();
+        if (R__unlikely(count < 0)) {
+            printf("Failed to get entries via the 'fast' method for index %lld.\n", evt_idx);
+            return -1;
+        }
+        count = std::min<Long64_t>(count, events - evt_idx);
+        float *entry = reinterpret_cast<float*>(branchbuf.GetCurrent());
+        consumer.Start();
+        for (Int_t idx=0; idx<count; idx++) {
+            idx_f++;
+            if (R__unlikely((evt_idx < 16000000) && (entry[idx] != idx_f))) {
+                printf("Incorrect value on myFloat branch: %f (event %lld)\n", entry[idx], evt_idx + idx);
+                return -1;
+            }
+        }
+        consumer.Stop();
+        evt_idx += count;
+    }
+    ctx.StopTimer();
+    ctx.bytes = evt_idx * sizeof(float);
+    if (ctx.phases) {
+        ctx.AddMetric("baskets", fetch.GetIntervals());
+        ctx.AddMetric("fetch_s", fetch.GetSeconds());
+        ctx.AddMetric("consumer_s", consumer.GetSeconds());
+    }
+    return evt_idx;
+}
+
+/**
+ * bulkinline with every buffer drawn from the BufferPool.  ROOT decompresses
+ * each basket straight into a pooled TBufferFile, sized up front from the
+ * largest basket so it never grows; the payload then sits behind the key
+ * header at no particular alignment, so it is decoded into a second, 64-byte
+ * aligned pooled buffer that the consumer loop runs over.
+ */
+static Long64_t ReadBulkPooled(BenchmarkContext &ctx) {
+    TBranch *branchF = GetFloatBranch(ctx);
+    if (!branchF) {return -1;}
+    BufferPool &pool = BufferPool::Get();
+    pool.SetHugePages(ctx.hugepages);
+    Long64_t allocations = pool.GetAllocations(), reuses = pool.GetReuses();
+    Long64_t fallbacks = pool.GetHugePageFallbacks();
+
+    std::vector<Long64_t> boundaries = GetBasketBoundaries(branchF);
+    Long64_t max_entries = 1;
+    for (size_t idx = 1; idx < boundaries.size(); idx++) {
+        max_entries = std::max(max_entries, boundaries[idx] - boundaries[idx-1]);
+    }
+    // Leave room for the key header in front of the payload.
+    PooledBufferFile branchbuf(max_entries * sizeof(float) + 4096);
+    char *native_buf = pool.Acquire(max_entries * sizeof(float));
+    if (!native_buf) {
+        printf("Failed to acquire a pooled buffer of %lld bytes.\n", max_entries * (Long64_t)sizeof(float));
+        return -1;
+    }
+    Long64_t events = std::min(ctx.events, ctx.tree->GetEntries());
+    float idx_f = 1;
+    Long64_t evt_idx = 0;
+    ctx.StartTimer();
+    while (evt_idx < events) {
+        auto count = branchF->GetBulkRead().GetEntriesSerialized(evt_idx, branchbuf);
+        if (R__unlikely(count < 0)) {
+            printf("Failed to get entries via the 'serialized' method for index %lld.\n", evt_idx);
+            pool.Release(native_buf);
+            return -1;
+        }
+        count = std::min<Long64_t>(count, events - evt_idx);
+        float *entry = static_cast<float*>(__builtin_assume_aligned(native_buf, 64));
+        DecodeBigEndian(branchbuf.GetCurrent(), entry, count);
+        for (Int_t idx=0; idx<count; idx++) {
+            idx_f++;
+            if (R__unlikely((evt_idx < 16000000) && (entry[idx] != idx_f))) {
+                printf("Incorrect value on myFloat branch: %f (event %lld)\n", entry[idx], evt_idx + idx);
+                pool.Release(native_buf);
+                return -1;
+            }
+        }
+        evt_idx += count;
+    }
+    ctx.StopTimer();
+    pool.Release(native_buf);
+    ctx.bytes = evt_idx * sizeof(float);
+    ctx.AddMetric("hugepages", static_cast<int>(ctx.hugepages));
+    ctx.AddMetric("pool_allocations", pool.GetAllocations() - allocations);
+    ctx.AddMetric("pool_reuses", pool.GetReuses() - reuses);
+    ctx.AddMetric("hugepage_fallbacks", pool.GetHugePageFallbacks() - fallbacks);
+    return evt_idx;
+}
+
+/**
+ * Map the file and check the values straight out of the page cache.  With
+ * decode set, each basket is first converted into a small native buffer
+ * with the SIMD kernels; otherwise every value is swapped as it is read.
+ * Only works on files written without compression.
+ */
+static Long64_t ReadMappedImpl(BenchmarkContext &ctx, bool decode) {
+    TBranch *branchF = GetFloatBranch(ctx);
+    if (!branchF) {return -1;}
+    MappedBranchReader reader(ctx.fname, branchF, sizeof(float));
+    if (!reader.IsValid()) {return -1;}
+    std::vector<float> native;
+    Long64_t events = std::min(ctx.events, ctx.tree->GetEntries());
+    float idx_f = 1;
+    Long64_t evt_idx = 0;
+    ctx.StartTimer();
+    while (evt_idx < events) {
+        const char *data;
+        Long64_t count = reader.GetEntriesMapped(evt_idx, data);
+        if (R__unlikely(count <= 0)) {
+            printf("Failed to map entries for index %lld.\n", evt_idx);
+            return -1;
+        }
+        count = std::min<Long64_t>(count, events - evt_idx);
+        BigEndianView<float> view(data, count);
+        const float *entry = nullptr;
+        if (decode) {
+            native.resize(std::max<size_t>(native.size(), count));
+            view.Decode(native.data());
+            entry = native.data();
+        }
+        for (Int_t idx=0; idx<count; idx++) {
+            idx_f++;
+            float value = decode ? entry[idx] : view[idx];
+            if (R__unlikely((evt_idx < 16000000) && (value != idx_f))) {
+                printf("Incorrect value on myFloat branch: %f (event %lld)\n", value, evt_idx + idx);
+                return -1;
+            }
+        }
+        evt_idx += count;
+    }
+    ctx.StopTimer();
+    ctx.bytes = evt_idx * sizeof(float);
+    return evt_idx;
+}
+
+static Long64_t ReadMapped(BenchmarkContext &ctx) {
+    return ReadMappedImpl(ctx, false);
+}
+
+static Long64_t ReadMappedDecode(BenchmarkContext &ctx) {
+    return ReadMappedImpl(ctx, true);
+}
+
+/**
+ * The range predicate of the range modes: a window of values in the middle
+ * of the benchmark sequence (2 to events+1) selecting ctx.selectivity of it.
+ */
+static void GetRange(const BenchmarkContext &ctx, Long64_t events, double &low, double &high) {
+    double width = ctx.selectivity * events;
+    low = 2 + (events - width) / 2;
+    high = low + width;
+}
+
+/**
+ * Count the myFloat values in the range.  With skip set the per-basket
+ * statistics written by 'fillstats' are consulted first and baskets that
+ * cannot match are never read or decompressed; otherwise every basket is
+ * scanned, as the baseline.
+ */
+static Long64_t ReadRangeImpl(BenchmarkContext &ctx, bool skip) {
+    TBufferFile branchbuf(TBuffer::kWrite, 32*1024);
+    TBranch *branchF = GetFloatBranch(ctx);
+    if (!branchF) {return -1;}
+    Long64_t events = std::min(ctx.events, ctx.tree->GetEntries());
+    std::vector<BasketStat> stats;
+    if (skip && !ReadBasketStats(ctx.file, "myFloat", stats)) {
+        printf("No basket statistics for myFloat; write the file with the 'fillstats' mode.\n");
+        return -1;
+    }
+    std::vector<Long64_t> boundaries = GetBasketBoundaries(branchF);
+    if (skip && (stats.size() + 1 != boundaries.size())) {
+        printf("Basket statistics cover %zu baskets, the branch has %zu.\n", stats.size(), boundaries.size() - 1);
+        return -1;
+    }
+    double low, high;
+    GetRange(ctx, events, low, high);
+    Long64_t passed = 0, skipped = 0, scanned = 0;
+    ctx.StartTimer();
+    for (size_t basket = 0; (basket + 1 < boundaries.size()) && (boundaries[basket] < events); basket++) {
+        if (skip && !stats[basket].MayContain(low, high)) {
+            skipped++;
+            continue;
+        }
+        Long64_t evt_idx = boundaries[basket];
+        auto count = branchF->GetBulkRead().GetEntriesSerialized(evt_idx, branchbuf);
+        if (R__unlikely(count < 0)) {
+            printf("Failed to get entries via the 'serialized' method for index %lld.\n", evt_idx);
+            return -1;
+        }
+        count = std::min<Long64_t>(count, events - evt_idx);
+        float *entry = reinterpret_cast<float*>(branchbuf.GetCurrent());
+        DecodeBigEndianInPlace(entry, count);
+        for (Int_t idx=0; idx<count; idx++) {
+            passed += (entry[idx] >= low) && (entry[idx] < high);
+        }
+        scanned++;
+    }
+    ctx.StopTimer();
+    // Throughput is quoted against the whole range scanned, skipped or not.
+    ctx.bytes = events * sizeof(float);
+    ctx.AddMetric("selectivity", ctx.selectivity);
+    ctx.AddMetric("passed", passed);
+    ctx.AddMetric("baskets_read", scanned);
+    ctx.AddMetric("baskets_skipped", skipped);
+    return events;
+}
+
+static Long64_t ReadRangeScan(BenchmarkContext &ctx) {
+    return ReadRangeImpl(ctx, false);
+}
+
+static Long64_t ReadRangeSkip(BenchmarkContext &ctx) {
+    return ReadRangeImpl(ctx, true);
+}
+
+/**
+ * The myFloat column of the flat export written by columnarExport, checked
+ * straight out of the mapping: what a read costs without ROOT's framing,
+ * decompression or byte swapping.
+ */
+static Long64_t ReadFlat(BenchmarkContext &ctx) {
+    std::string fname = GetColumnarFileName(ctx.fname);
+    ColumnarFile file;
+    if (!file.Open(fname.c_str())) {
+        printf("Export the ROOT file first with: columnarExport %s\n", ctx.fname);
+        return -1;
+    }
+    const ColumnarColumn *column = file.FindColumn("myFloat");
+    const float *values = column ? file.GetValues<float>(*column) : nullptr;
+    if (!values || column->jagged) {
+        printf("No float column 'myFloat' in %s.\n", fname.c_str());
+        return -1;
+    }
+    Long64_t events = std::min<Long64_t>(ctx.events, file.GetEntries());
+    float idx_f = 1;
+    ctx.StartTimer();
+    for (Long64_t evt_idx = 0; evt_idx < events; evt_idx++) {
+        idx_f++;
+        if (R__unlikely((evt_idx < 16000000) && (values[evt_idx] != idx_f))) {
+            printf("Incorrect value on myFloat column: %f (event %lld)\n", values[evt_idx], evt_idx);
+            return -1;
+        }
+    }
+    ctx.StopTimer();
+    ctx.bytes = events * sizeof(float);
+    return events;
+}
+
+/**
+ * Make ctx.passes passes over the branch, as an iterative fit would, with
+ * baskets served from a BasketCache of ctx.cache_bytes after the first.
+ * With native set the cache holds byte-swapped values; otherwise every pass
+ * decodes the cached big-endian payload again.
+ */
+static Long64_t ReadCachedImpl(BenchmarkContext &ctx, bool native) {
+    TBranch *branchF = GetFloatBranch(ctx);
+    if (!branchF) {return -1;}
+    BasketCache cache(ctx.cache_bytes);
+    CachedBulkReader reader(cache, branchF, sizeof(float), native);
+    std::vector<float> decoded;
+    std::vector<double> pass_seconds;
+    Long64_t events = std::min(ctx.events, ctx.tree->GetEntries());
+    ctx.StartTimer();
+    for (int pass = 0; pass < ctx.passes; pass++) {
+        auto pass_start = std::chrono::steady_clock::now();
+        float idx_f = 1;
+        Long64_t evt_idx = 0;
+        while (evt_idx < events) {
+            const char *data;
+            Long64_t count = reader.GetEntries(evt_idx, data);
+            if (R__unlikely(count <= 0)) {
+                printf("Failed to get cached entries for index %lld.\n", evt_idx);
+                return -1;
+            }
+            count = std::min<Long64_t>(count, events - evt_idx);
+            const float *entry = reinterpret_cast<const float*>(data);
+            if (!native) {
+                decoded.resize(std::max<size_t>(decoded.size(), count));
+                DecodeBigEndian(data, decoded.data(), count);
+                entry = decoded.data();
+            }
+            for (Int_t idx=0; idx<count; idx++) {
+                idx_f++;
+                if (R__unlikely((evt_idx < 16000000) && (entry[idx] != idx_f))) {
+                    printf("Incorrect value on myFloat branch: %f (event %lld)\n", entry[idx], evt_idx + idx);
+                    return -1;
+                }
+            }
+            evt_idx += count;
+        }
+        pass_seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - pass_start).count());
+    }
+    ctx.StopTimer();
+    ctx.bytes = ctx.passes * events * sizeof(float);
+    double later = 0;
+    for (size_t pass = 1; pass < pass_seconds.size(); pass++) {later += pass_seconds[pass];}
+    if (pass_seconds.size() > 1) {later /= pass_seconds.size() - 1;}
+    ctx.AddMetric("passes", ctx.passes);
+    ctx.AddMetric("first_pass_s", pass_seconds.empty() ? 0 : pass_seconds.front());
+    ctx.AddMetric("later_pass_s", later);
+    ctx.AddMetric("later_pass_speedup", later > 0 ? pass_seconds.front() / later : 0);
+    ctx.AddMetric("cache_hits", cache.GetHits());
+    ctx.AddMetric("cache_misses", cache.GetMisses());
+    ctx.AddMetric("cache_evictions", cache.GetEvictions());
+    ctx.AddMetric("cache_MB", cache.GetBytes() / 1e6);
+    return ctx.passes * events;
+}
+
+static Long64_t ReadCached(BenchmarkContext &ctx) {
+    return ReadCachedImpl(ctx, true);
+}
+
+static Long64_t ReadCachedSerialized(BenchmarkContext &ctx) {
+    return ReadCachedImpl(ctx, false);
+}
+
+/**
+ * Read the compressed bytes of every basket straight from the file, without
+ * decompressing them.  Together with 'unzip' this splits a read mode's time
+ * into I/O, decompression and deserialization.  With --direct-io the reads
+ * bypass TFile and the page cache.
+ */
+static Long64_t ReadRawIO(BenchmarkContext &ctx) {
+    TBranch *branchF = GetFloatBranch(ctx);
+    if (!branchF) {return -1;}
+    Long64_t entries;
+    Int_t baskets = CoveringBaskets(branchF, ctx.events, entries);
+    Int_t *basket_bytes = branchF->GetBasketBytes();
+    RawFileReader direct;
+    if (ctx.direct_io && ctx.url) {
+        printf("--direct-io reads the local file and cannot be combined with a URL.\n");
+        return -1;
+    }
+    if (ctx.direct_io && !direct.Open(ctx.fname, true)) {return -1;}
+    std::vector<char> buf;
+    Long64_t zip_bytes = 0;
+    ctx.StartTimer();
+    for (Int_t ib = 0; ib < baskets; ib++) {
+        buf.resize(std::max<size_t>(buf.size(), basket_bytes[ib]));
+        bool failed = ctx.direct_io ? !direct.Read(buf.data(), branchF->GetBasketSeek(ib), basket_bytes[ib])
+                                    : ctx.file->ReadBuffer(buf.data(), branchF->GetBasketSeek(ib), basket_bytes[ib]);
+        if (R__unlikely(failed)) {
+            printf("Failed to read basket %d of branch 'myFloat'.\n", ib);
+            return -1;
+        }
+        zip_bytes += basket_bytes[ib];
+    }
+    ctx.StopTimer();
+    ctx.bytes = entries * sizeof(float);
+    ctx.AddMetric("baskets", baskets);
+    ctx.AddMetric("zip_bytes", zip_bytes);
+    return entries;
+}
+
+/**
+ * Read and decompress every basket with TBranch::GetBasket but never look at
+ * the entries.  Baskets are dropped as soon as they are loaded so memory
+ * stays bounded.
+ */
+static Long64_t ReadUnzip(BenchmarkContext &ctx) {
+    TBranch *branchF = GetFloatBranch(ctx);
+    if (!branchF) {return -1;}
+    Long64_t entries;
+    Int_t baskets = CoveringBaskets(branchF, ctx.events, entries);
+    ctx.StartTimer();
+    for (Int_t ib = 0; ib < baskets; ib++) {
+        if (R__unlikely(!branchF->GetBasket(ib))) {
+            printf("Failed to load basket %d of branch 'myFloat'.\n", ib);
+            return -1;
+        }
+        branchF->DropBaskets("all");
+    }
+    ctx.StopTimer();
+    ctx.bytes = entries * sizeof(float);
+    ctx.AddMetric("baskets", baskets);
+    return entries;
+}
+
+const std::vector<BenchmarkMode> &GetReadModes() {
+    static const std::vector<BenchmarkMode> modes = {
+        {"standard", "TTreeReader / TTreeReaderValue<float>", ReadStandard},
+        {"fastreader", "TTreeReaderFast / TTreeReaderValueFast<float>", ReadFastReader},
+        {"bulk", "TBulkBranchRead::GetEntriesFast", ReadBulk},
+        {"bulkinline", "TBulkBranchRead::GetEntriesSerialized with SIMD in-place byte swap", ReadBulkInline},
+        {"bulkinlinescalar", "TBulkBranchRead::GetEntriesSerialized with a scalar byte-swap loop", ReadBulkInlineScalar},
+        {"bulkparallel", "GetEntriesFast over basket-aligned ranges, one TFile per thread", ReadBulkParallel, true},
+        {"parallelunzip", "One thread reading compressed baskets, --threads workers decompressing them, in order", ReadParallelUnzip, true, false, true},
+        {"bulkprefetch", "GetEntriesFast on a producer thread with --depth baskets in flight", ReadBulkPrefetch},
+        {"bulkpooled", "bulkinline over pooled, 64-byte aligned buffers; see --hugepages", ReadBulkPooled},
+        {"mmap", "Uncompressed files only: values read straight from a mapping, swapped on access", ReadMapped, false, false, true, false},
+        {"mmapdecode", "Uncompressed files only: mapping decoded per basket with the SIMD kernels", ReadMappedDecode, false, false, true, false},
+        {"standardanalysis", "--kernel filled entry by entry from TTreeReaderValue<float>", ReadStandardAnalysis},
+        {"bulkanalysis", "bulkinline feeding each basket to the scalar --kernel loops", ReadBulkAnalysis},
+        {"bulkanalysissimd", "bulkinline feeding each basket to the AVX2 --kernel loops", ReadBulkAnalysisSimd},
+        {"rangescan", "Count values in a --selectivity range, decompressing every basket", ReadRangeScan},
+        {"rangeskip", "rangescan skipping baskets ruled out by the 'fillstats' min/max statistics", ReadRangeSkip, false, false, false, false},
+        {"flat", "Flat little-endian column exported by columnarExport, read from a mapping", ReadFlat, false, false, true, false},
+        {"cached", "--passes over the data through an LRU cache of byte-swapped baskets", ReadCached},
+        {"cachedserialized", "--passes through an LRU cache of big-endian baskets, decoded every pass", ReadCachedSerialized},
+        {"rawio", "Compressed basket bytes via TFile::ReadBuffer (or O_DIRECT with --direct-io); no decompression", ReadRawIO},
+        {"unzip", "TBranch::GetBasket for every basket: I/O plus decompression only", ReadUnzip},
+    };
+    return modes;
+}
+
+const BenchmarkMode *FindReadMode(const std::string &name) {
+    for (const auto &mode : GetReadModes()) {
+        if (name == mode.name) {return &mode;}
+    }
+    return nullptr;
+}
@@ -0,0 +1,20 @@
+#ifndef BULKAPI_READ_MODES_H
+#define BULKAPI_READ_MODES_H
+
+#include <string>
+#include <vector>
+
+#include "BenchmarkContext.h"
+
+/**
+ * The read modes of the float micro benchmark, runnable from a single driver.
+ *
+ * Each mode reads the 'myFloat' branch of tree 'T' as written by
+ * floatMicroBenchmark and checks the values against the expected sequence.
+ */
+const std::vector<BenchmarkMode> &GetReadModes();
+
+/// Returns nullptr if there is no mode with the given name.
+const BenchmarkMode *FindReadMode(const std::string &name);
+
+#endif  // BULKAPI_READ_MODES_H
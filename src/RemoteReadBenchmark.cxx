@@ -0,0 +1,239 @@
+#include <getopt.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "TFile.h"
+
+#include "BasketUtils.h"
+#include "BenchmarkContext.h"
+#include "BenchmarkResults.h"
+#include "BenchmarkRunner.h"
+#include "LoopbackFileServer.h"
+#include "ReadModes.h"
+#include "WriteModes.h"
+
+/**
+ * Writes the float benchmark file, serves it over HTTP from a
+ * LoopbackFileServer with injected latency and bandwidth, and reads it by
+ * URL with every mode, with and without a TTreeCache.
+ *
+ * Each result row is one (latency, cache size, read mode) cell.  The
+ * server's request counts give the round trips of one read, not counting
+ * opening the file and the tree (including the extra opens of modes that
+ * read through their own TFile), and the round trips per basket.
+ */
+
+static void Usage(const char *prog, const DriverOptions &defaults) {
+    fprintf(stderr, "Usage: %s [options] events fname\n", prog);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -l, --latencies LIST     Comma-separated round-trip latencies in ms (default: 1,10,50).\n");
+    fprintf(stderr, "  -B, --bandwidth MB       Bandwidth per connection in MB/s; 0 is unlimited (default: 0).\n");
+    fprintf(stderr, "  -s, --cache-sizes LIST   Comma-separated TTreeCache sizes in bytes; 0 disables the cache and\n");
+    fprintf(stderr, "                           'default' keeps ROOT's (default: 0,default).\n");
+    fprintf(stderr, "  -m, --modes LIST         Comma-separated read modes (default: standard,fastreader,bulk,bulkprefetch).\n");
+    fprintf(stderr, "  -d, --depth N            Baskets in flight for bulkprefetch (default: 2).\n");
+    fprintf(stderr, "  -W, --write-mode NAME    Write mode used to create the file (default: fill).\n");
+    fprintf(stderr, "  -c, --compression N      ROOT compression settings, e.g. 407 or 0 (default: ROOT's).\n");
+    fprintf(stderr, "  -b, --basket-size N      Basket size in bytes (default: 320000).\n");
+    PrintDriverUsage(defaults, 24);
+}
+
+static bool ParseNumber(const char *arg, const char *what, double &value) {
+    try {
+        value = std::stod(arg);
+    } catch (...) {
+        fprintf(stderr, "Failed to parse %s (%s) to a number.\n", what, arg);
+        return false;
+    }
+    if (value < 0) {
+        fprintf(stderr, "%s must be non-negative (got %s).\n", what, arg);
+        return false;
+    }
+    return true;
+}
+
+/// Round trips spent opening the file and fetching the tree, which every repetition pays once.
+static Long64_t CountOpenRoundTrips(const LoopbackFileServer &server) {
+    Long64_t before = server.GetRequests();
+    std::unique_ptr<TFile> hfile(TFile::Open(server.GetURL().c_str()));
+    if (!hfile || hfile->IsZombie() || !hfile->Get("T")) {return -1;}
+    return server.GetRequests() - before;
+}
+
+/**
+ * Read the file through one server with every mode and cache size,
+ * appending one result per cell.
+ */
+static bool RunLatency(double latency_ms, double bandwidth, const std::vector<Long64_t> &cache_sizes,
+                       const std::vector<const BenchmarkMode*> &read_modes, Long64_t baskets,
+                       const BenchmarkContext &options, Long64_t warmup, Long64_t repetitions,
+                       std::vector<BenchmarkResult> &results) {
+    LoopbackFileServer server(options.fname, latency_ms, bandwidth);
+    if (!server.Start()) {return false;}
+    Long64_t open_trips = CountOpenRoundTrips(server);
+    if (open_trips < 0) {
+        fprintf(stderr, "Failed to open %s.\n", server.GetURL().c_str());
+        return false;
+    }
+    char latency[32];
+    snprintf(latency, sizeof(latency), "%g", latency_ms);
+    for (Long64_t bytes : cache_sizes) {
+        BenchmarkContext cell(options);
+        cell.url = server.GetURL().c_str();
+        cell.tree_cache_bytes = bytes;
+        for (const BenchmarkMode *mode : read_modes) {
+            Long64_t requests = server.GetRequests(), ranges = server.GetRanges(), sent = server.GetBytesSent();
+            BenchmarkResult result;
+            if (!RunMode(*mode, cell, 1, warmup, repetitions, result)) {return false;}
+            double reads = warmup + repetitions;
+            // Modes with their own TFile (bulkprefetch, bulkparallel) pay for its open on top of the runner's.
+            double opens = 1 + result.GetMetric("extra_file_opens");
+            double trips = (server.GetRequests() - requests) / reads - open_trips * opens;
+            result.mode = std::string("latency=") + latency + "ms/cache=" + CacheSizeLabel(bytes) + "/" + mode->name;
+            result.metrics.emplace_back("latency_ms", latency_ms);
+            result.metrics.emplace_back("bandwidth_MB_s", bandwidth);
+            result.metrics.emplace_back("cache_bytes", bytes);
+            result.metrics.emplace_back("open_round_trips", open_trips * opens);
+            result.metrics.emplace_back("round_trips", trips);
+            result.metrics.emplace_back("round_trips_per_basket", baskets > 0 ? trips / baskets : 0);
+            result.metrics.emplace_back("ranges_per_read", (server.GetRanges() - ranges) / reads);
+            result.metrics.emplace_back("MB_served_per_read", (server.GetBytesSent() - sent) / reads / 1e6);
+            results.push_back(result);
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+
+    // Handle all the argument parsing up front.
+    std::vector<double> latencies;
+    double bandwidth = 0;
+    std::vector<Long64_t> cache_sizes;
+    std::vector<const BenchmarkMode*> read_modes;
+    const BenchmarkMode *write_mode = FindWriteMode("fill");
+    DriverOptions driver;
+    driver.warmup = 0;
+    const DriverOptions defaults(driver);
+    BenchmarkContext options;
+
+    static const struct option long_options[] = {
+        {"latencies", required_argument, nullptr, 'l'},
+        {"bandwidth", required_argument, nullptr, 'B'},
+        {"cache-sizes", required_argument, nullptr, 's'},
+        {"modes", required_argument, nullptr, 'm'},
+        {"depth", required_argument, nullptr, 'd'},
+        {"write-mode", required_argument, nullptr, 'W'},
+        {"compression", required_argument, nullptr, 'c'},
+        {"basket-size", required_argument, nullptr, 'b'},
+        {"warmup", required_argument, nullptr, 'w'},
+        {"repetitions", required_argument, nullptr, 'r'},
+        {"format", required_argument, nullptr, 'f'},
+        {"output", required_argument, nullptr, 'o'},
+        {"keep", no_argument, nullptr, 'k'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "l:B:s:m:d:W:c:b:w:r:f:o:kh", long_options, nullptr)) != -1) {
+        OptionStatus status = ParseDriverOption(opt, optarg, driver);
+        if (status == OptionStatus::kError) {return 1;}
+        if (status == OptionStatus::kHandled) {continue;}
+        switch (opt) {
+        case 'l': {
+            std::stringstream ss(optarg);
+            std::string item;
+            while (std::getline(ss, item, ',')) {
+                double latency;
+                if (!ParseNumber(item.c_str(), "latency", latency)) {return 1;}
+                latencies.push_back(latency);
+            }
+            break;
+        }
+        case 'B':
+            if (!ParseNumber(optarg, "bandwidth", bandwidth)) {return 1;}
+            break;
+        case 's':
+            if (!ParseCacheSizes(optarg, cache_sizes)) {return 1;}
+            break;
+        case 'm':
+            if (!ParseReadModes(optarg, read_modes)) {return 1;}
+            for (const BenchmarkMode *mode : read_modes) {
+                if (mode->local) {
+                    fprintf(stderr, "Mode %s reads the local file directly, not through the server.\n", mode->name);
+                    return 1;
+                }
+            }
+            break;
+        case 'd': {
+            Long64_t depth;
+            if (!ParseCount(optarg, "prefetch depth", depth)) {return 1;}
+            if (!depth) {
+                fprintf(stderr, "Prefetch depth must be at least 1.\n");
+                return 1;
+            }
+            options.prefetch_depth = depth;
+            break;
+        }
+        case 'W':
+            write_mode = FindWriteMode(optarg);
+            if (!write_mode) {
+                fprintf(stderr, "Unknown write mode: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'c': {
+            Long64_t compression;
+            if (!ParseCount(optarg, "compression settings", compression)) {return 1;}
+            options.compression = compression;
+            break;
+        }
+        case 'b': {
+            Long64_t basket_size;
+            if (!ParseCount(optarg, "basket size", basket_size)) {return 1;}
+            options.basket_size = basket_size;
+            break;
+        }
+        case 'h':
+            Usage(argv[0], defaults);
+            return 0;
+        default:
+            Usage(argv[0], defaults);
+            return 1;
+        }
+    }
+    if (argc - optind != 2) {
+        Usage(argv[0], defaults);
+        return 1;
+    }
+    if (!ParseCount(argv[optind], "event count", options.events)) {return 1;}
+    const char *fname = argv[optind + 1];
+    options.fname = fname;
+    if (latencies.empty()) {latencies = {1, 10, 50};}
+    if (cache_sizes.empty()) {cache_sizes = {0, -1};}
+    if (read_modes.empty()) {
+        for (const char *name : {"standard", "fastreader", "bulk", "bulkprefetch"}) {read_modes.push_back(FindReadMode(name));}
+    }
+    // End arg parsing.
+
+    BenchmarkResult written;
+    std::vector<BenchmarkResult> results;
+    bool ok = RunMode(*write_mode, options, 1, 0, 1, written);
+    Long64_t baskets = ok ? CountBaskets(fname) : 0;
+    for (double latency : latencies) {
+        if (!ok) {break;}
+        ok = RunLatency(latency, bandwidth, cache_sizes, read_modes, baskets, options, driver.warmup,
+                        driver.repetitions, results);
+    }
+    if (!driver.keep) {unlink(fname);}
+    if (!ok) {return 1;}
+
+    if (!WriteResultsTo(driver.output, driver.format, fname, results)) {return 1;}
+
+    return 0;
+}
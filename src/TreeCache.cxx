@@ -0,0 +1,62 @@
+
+#include <stdio.h>
+#include <string.h>
+
+#include "TTree.h"
+
+#include "TreeCache.h"
+
+bool ParseCacheBranches(const char *name, CacheBranches &branches) {
+    if (!strcmp(name, "learn")) {
+        branches = CacheBranches::kLearn;
+    } else if (!strcmp(name, "used")) {
+        branches = CacheBranches::kUsed;
+    } else if (!strcmp(name, "all")) {
+        branches = CacheBranches::kAll;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char *GetCacheBranchesName(CacheBranches branches) {
+    switch (branches) {
+    case CacheBranches::kLearn:
+        return "learn";
+    case CacheBranches::kUsed:
+        return "used";
+    case CacheBranches::kAll:
+        return "all";
+    }
+    return "unknown";
+}
+
+bool ConfigureTreeCache(TTree *tree, Long64_t bytes, int learn_entries, CacheBranches branches) {
+    // The learn-entry count is read when the cache is created.
+    if (learn_entries >= 0) {tree->SetCacheLearnEntries(learn_entries);}
+    if (bytes >= 0 && tree->SetCacheSize(bytes) < 0) {
+        printf("Failed to set a TTreeCache of %lld bytes.\n", bytes);
+        return false;
+    }
+    if ((branches == CacheBranches::kLearn) || !bytes) {return true;}
+    const char *selection = (branches == CacheBranches::kUsed) ? "myFloat" : "*";
+    if (tree->AddBranchToCache(selection, kTRUE) < 0) {
+        printf("Failed to add branches '%s' to the TTreeCache.\n", selection);
+        return false;
+    }
+    tree->StopCacheLearningPhase();
+    return true;
+}
+
+bool GetReadSyscallCounts(ReadSyscallCounts &counts) {
+    FILE *fp = fopen("/proc/self/io", "r");
+    if (!fp) {return false;}
+    char line[256];
+    int found = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "syscr: %lld", &counts.calls) == 1) {found++;}
+        if (sscanf(line, "rchar: %lld", &counts.bytes) == 1) {found++;}
+    }
+    fclose(fp);
+    return found == 2;
+}
@@ -0,0 +1,38 @@
+#ifndef BULKAPI_TREE_CACHE_H
+#define BULKAPI_TREE_CACHE_H
+
+#include "Rtypes.h"
+
+class TTree;
+
+/// Which branches a TTreeCache prefetches.
+enum class CacheBranches {
+    kLearn,  // Whatever the learning phase sees being read.
+    kUsed,   // 'myFloat', the branch the read modes use; no learning phase.
+    kAll     // Every branch of the tree; no learning phase.
+};
+
+bool ParseCacheBranches(const char *name, CacheBranches &branches);
+const char *GetCacheBranchesName(CacheBranches branches);
+
+/**
+ * Set up the TTreeCache of `tree` before a read.  `bytes` of -1 leaves
+ * ROOT's default cache alone and 0 disables it; `learn_entries` of -1 keeps
+ * ROOT's default learning phase.  The learn-entry count is global in ROOT,
+ * so it affects every tree opened afterwards too.  Returns false on error.
+ */
+bool ConfigureTreeCache(TTree *tree, Long64_t bytes, int learn_entries, CacheBranches branches);
+
+/**
+ * Read syscalls made by the whole process and the bytes they returned, from
+ * /proc/self/io.  Page cache hits count too.
+ */
+struct ReadSyscallCounts {
+    Long64_t calls{0};
+    Long64_t bytes{0};
+};
+
+/// False where /proc/self/io is unavailable.
+bool GetReadSyscallCounts(ReadSyscallCounts &counts);
+
+#endif  // BULKAPI_TREE_CACHE_H
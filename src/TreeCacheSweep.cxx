@@ -0,0 +1,202 @@
+#include <getopt.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BenchmarkContext.h"
+#include "BenchmarkResults.h"
+#include "BenchmarkRunner.h"
+#include "ReadModes.h"
+#include "WriteModes.h"
+
+/**
+ * Writes the float benchmark file once, then reads it over a grid of
+ * TTreeCache settings: cache size, entries in the learning phase and which
+ * branches the cache prefetches.
+ *
+ * Each result row is one (cache size, learn entries, branches, read mode)
+ * cell with the read syscalls, bytes per syscall and TFile read calls as
+ * metrics, so it shows whether a read path goes through the cache's
+ * vectored reads at all.  With the cache off the other two settings do not
+ * matter, so that cell is read once.
+ */
+
+static void Usage(const char *prog, const DriverOptions &defaults) {
+    fprintf(stderr, "Usage: %s [options] events fname\n", prog);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -s, --cache-sizes LIST   Comma-separated TTreeCache sizes in bytes; 0 disables the cache and\n");
+    fprintf(stderr, "                           'default' keeps ROOT's (default: 0,default,1048576,10485760,104857600).\n");
+    fprintf(stderr, "  -l, --learn-entries LIST Comma-separated learning-phase lengths in entries (default: 1,10,100).\n");
+    fprintf(stderr, "  -B, --branches LIST      Comma-separated branch selections: learn (the learning phase picks),\n");
+    fprintf(stderr, "                           used (myFloat only) or all (default: learn,used,all).\n");
+    fprintf(stderr, "  -m, --modes LIST         Comma-separated read modes (default: standard,fastreader,bulk).\n");
+    fprintf(stderr, "  -W, --write-mode NAME    Write mode used to create the file (default: fill).\n");
+    fprintf(stderr, "  -c, --compression N      ROOT compression settings, e.g. 407 or 0 (default: ROOT's).\n");
+    fprintf(stderr, "  -b, --basket-size N      Basket size in bytes (default: 320000).\n");
+    fprintf(stderr, "  -K, --page-cache STATE   Page cache state before each read: asis, cold or warm (default: asis).\n");
+    PrintDriverUsage(defaults, 24);
+}
+
+/**
+ * Read the file with every mode in every cell of the grid, appending one
+ * result per cell and mode.
+ */
+static bool RunSweep(const std::vector<Long64_t> &cache_sizes, const std::vector<Long64_t> &learn_entries,
+                     const std::vector<CacheBranches> &selections, const std::vector<const BenchmarkMode*> &read_modes,
+                     const BenchmarkContext &options, Long64_t warmup, Long64_t repetitions,
+                     std::vector<BenchmarkResult> &results) {
+    for (Long64_t bytes : cache_sizes) {
+        for (Long64_t learn : bytes ? learn_entries : std::vector<Long64_t>{learn_entries.front()}) {
+            for (CacheBranches branches : bytes ? selections : std::vector<CacheBranches>{CacheBranches::kLearn}) {
+                BenchmarkContext cell(options);
+                cell.tree_cache_bytes = bytes;
+                cell.cache_learn_entries = learn;
+                cell.cache_branches = branches;
+                std::string label = "cache=" + CacheSizeLabel(bytes);
+                if (bytes) {label += "/learn=" + std::to_string(learn) + "/branches=" + GetCacheBranchesName(branches);}
+                for (const BenchmarkMode *mode : read_modes) {
+                    BenchmarkResult result;
+                    if (!RunMode(*mode, cell, 1, warmup, repetitions, result)) {return false;}
+                    result.mode = label + "/" + mode->name;
+                    result.metrics.emplace_back("cache_bytes", bytes);
+                    result.metrics.emplace_back("learn_entries", learn);
+                    results.push_back(result);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+
+    // Handle all the argument parsing up front.
+    std::vector<Long64_t> cache_sizes;
+    std::vector<Long64_t> learn_entries;
+    std::vector<CacheBranches> selections;
+    std::vector<const BenchmarkMode*> read_modes;
+    const BenchmarkMode *write_mode = FindWriteMode("fill");
+    DriverOptions driver;
+    const DriverOptions defaults(driver);
+    BenchmarkContext options;
+    options.io_counts = true;
+
+    static const struct option long_options[] = {
+        {"cache-sizes", required_argument, nullptr, 's'},
+        {"learn-entries", required_argument, nullptr, 'l'},
+        {"branches", required_argument, nullptr, 'B'},
+        {"modes", required_argument, nullptr, 'm'},
+        {"write-mode", required_argument, nullptr, 'W'},
+        {"compression", required_argument, nullptr, 'c'},
+        {"basket-size", required_argument, nullptr, 'b'},
+        {"page-cache", required_argument, nullptr, 'K'},
+        {"warmup", required_argument, nullptr, 'w'},
+        {"repetitions", required_argument, nullptr, 'r'},
+        {"format", required_argument, nullptr, 'f'},
+        {"output", required_argument, nullptr, 'o'},
+        {"keep", no_argument, nullptr, 'k'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "s:l:B:m:W:c:b:K:w:r:f:o:kh", long_options, nullptr)) != -1) {
+        OptionStatus status = ParseDriverOption(opt, optarg, driver);
+        if (status == OptionStatus::kError) {return 1;}
+        if (status == OptionStatus::kHandled) {continue;}
+        switch (opt) {
+        case 's':
+            if (!ParseCacheSizes(optarg, cache_sizes)) {return 1;}
+            break;
+        case 'l': {
+            std::stringstream ss(optarg);
+            std::string item;
+            while (std::getline(ss, item, ',')) {
+                Long64_t entries;
+                if (!ParseCount(item.c_str(), "learn entries", entries)) {return 1;}
+                if (!entries) {
+                    fprintf(stderr, "The learning phase needs at least one entry.\n");
+                    return 1;
+                }
+                learn_entries.push_back(entries);
+            }
+            break;
+        }
+        case 'B': {
+            std::stringstream ss(optarg);
+            std::string name;
+            while (std::getline(ss, name, ',')) {
+                CacheBranches branches;
+                if (!ParseCacheBranches(name.c_str(), branches)) {
+                    fprintf(stderr, "Branch selection must be 'learn', 'used', or 'all'\n");
+                    return 1;
+                }
+                selections.push_back(branches);
+            }
+            break;
+        }
+        case 'm':
+            if (!ParseReadModes(optarg, read_modes)) {return 1;}
+            break;
+        case 'W':
+            write_mode = FindWriteMode(optarg);
+            if (!write_mode) {
+                fprintf(stderr, "Unknown write mode: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'c': {
+            Long64_t compression;
+            if (!ParseCount(optarg, "compression settings", compression)) {return 1;}
+            options.compression = compression;
+            break;
+        }
+        case 'b': {
+            Long64_t basket_size;
+            if (!ParseCount(optarg, "basket size", basket_size)) {return 1;}
+            options.basket_size = basket_size;
+            break;
+        }
+        case 'K':
+            if (!ParsePageCache(optarg, options.page_cache)) {
+                fprintf(stderr, "Page cache state must be 'asis', 'cold', or 'warm'\n");
+                return 1;
+            }
+            break;
+        case 'h':
+            Usage(argv[0], defaults);
+            return 0;
+        default:
+            Usage(argv[0], defaults);
+            return 1;
+        }
+    }
+    if (argc - optind != 2) {
+        Usage(argv[0], defaults);
+        return 1;
+    }
+    if (!ParseCount(argv[optind], "event count", options.events)) {return 1;}
+    const char *fname = argv[optind + 1];
+    options.fname = fname;
+    if (cache_sizes.empty()) {cache_sizes = {0, -1, 1048576, 10485760, 104857600};}
+    if (learn_entries.empty()) {learn_entries = {1, 10, 100};}
+    if (selections.empty()) {selections = {CacheBranches::kLearn, CacheBranches::kUsed, CacheBranches::kAll};}
+    if (read_modes.empty()) {
+        for (const char *name : {"standard", "fastreader", "bulk"}) {read_modes.push_back(FindReadMode(name));}
+    }
+    // End arg parsing.
+
+    BenchmarkResult written;
+    std::vector<BenchmarkResult> results;
+    bool ok = RunMode(*write_mode, options, 1, 0, 1, written) &&
+              RunSweep(cache_sizes, learn_entries, selections, read_modes, options, driver.warmup, driver.repetitions,
+                       results);
+    if (!driver.keep) {unlink(fname);}
+    if (!ok) {return 1;}
+
+    if (!WriteResultsTo(driver.output, driver.format, fname, results)) {return 1;}
+
+    return 0;
+}
@@ -1,3 +1,5 @@
+#ifndef BULKAPI_VARIABLE_LENGTH_STRUCT_H
+#define BULKAPI_VARIABLE_LENGTH_STRUCT_H
 
 #include "Rtypes.h"
 #include "TObject.h"
@@ -18,3 +20,4 @@ public:
    ClassDef(VariableLengthStruct, 1)
 };
 
+#endif  // BULKAPI_VARIABLE_LENGTH_STRUCT_H
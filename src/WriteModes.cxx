@@ -0,0 +1,168 @@
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <memory>
+
+#include "TBranch.h"
+#include "TFile.h"
+#include "TTree.h"
+
+#include "BasketStatistics.h"
+#include "BulkTreeWriter.h"
+#include "ParallelTreeWriter.h"
+#include "WriteModes.h"
+
+static TFile *CreateOutput(BenchmarkContext &ctx) {
+    TFile *hfile = TFile::Open(ctx.fname, "RECREATE", "TTree float micro benchmark ROOT file");
+    if (!hfile || hfile->IsZombie()) {
+        printf("Failed to create file %s.\n", ctx.fname);
+        delete hfile;
+        return nullptr;
+    }
+    if (ctx.compression >= 0) {
+        hfile->SetCompressionSettings(ctx.compression);
+    }
+    return hfile;
+}
+
+static Long64_t WriteFill(BenchmarkContext &ctx) {
+    std::unique_ptr<TFile> hfile(CreateOutput(ctx));
+    if (!hfile) {return -1;}
+    TTree *tree = new TTree("T", "A ROOT tree of floats.");
+    float f = 2;
+    TBranch *branch2 = tree->Branch("myFloat", &f, ctx.basket_size, 1);
+    branch2->SetAutoDelete(kFALSE);
+    ctx.StartTimer();
+    for (Long64_t ev = 0; ev < ctx.events; ev++) {
+        tree->Fill();
+        f++;
+    }
+    hfile->Write();
+    ctx.StopTimer();
+    ctx.bytes = ctx.events * sizeof(float);
+    ctx.AddMetric("tot_bytes", tree->GetTotBytes());
+    ctx.AddMetric("zip_bytes", tree->GetZipBytes());
+    hfile->Close();
+    return ctx.events;
+}
+
+/**
+ * As 'fill', also recording per-basket min/max statistics of myFloat into a
+ * side tree for the basket-skipping read mode.
+ */
+static Long64_t WriteFillStats(BenchmarkContext &ctx) {
+    std::unique_ptr<TFile> hfile(CreateOutput(ctx));
+    if (!hfile) {return -1;}
+    TTree *tree = new TTree("T", "A ROOT tree of floats.");
+    float f = 2;
+    TBranch *branch2 = tree->Branch("myFloat", &f, ctx.basket_size, 1);
+    branch2->SetAutoDelete(kFALSE);
+    BasketStatsRecorder stats(branch2);
+    ctx.StartTimer();
+    for (Long64_t ev = 0; ev < ctx.events; ev++) {
+        stats.Fill(f);
+        tree->Fill();
+        stats.Update();
+        f++;
+    }
+    tree->FlushBaskets();
+    stats.Update();
+    if (!stats.Write(hfile.get())) {return -1;}
+    hfile->Write();
+    ctx.StopTimer();
+    ctx.bytes = ctx.events * sizeof(float);
+    ctx.AddMetric("tot_bytes", tree->GetTotBytes());
+    ctx.AddMetric("zip_bytes", tree->GetZipBytes());
+    ctx.AddMetric("stats_baskets", stats.GetStats().size());
+    hfile->Close();
+    return ctx.events;
+}
+
+static Long64_t WriteBulk(BenchmarkContext &ctx) {
+    std::unique_ptr<TFile> hfile(CreateOutput(ctx));
+    if (!hfile) {return -1;}
+    TTree *tree = new TTree("T", "A ROOT tree of floats.");
+    BulkColumnWriter<float> writerF(tree, "myFloat", ctx.basket_size);
+    std::vector<float> values(std::min<Long64_t>(std::max<Long64_t>(ctx.events, 1), 1024*1024));
+    BulkClusterTracker clusters(tree);
+    float f = 2;
+    ctx.StartTimer();
+    for (Long64_t ev = 0, count; ev < ctx.events; ev += count) {
+        count = clusters.GetRoom(std::min<Long64_t>(values.size(), ctx.events - ev));
+        for (Long64_t idx = 0; idx < count; idx++) {values[idx] = f++;}
+        if (R__unlikely((writerF.Fill(values.data(), count) < 0) || !clusters.Advance(count))) {
+            printf("Failed to write entries via the bulk API at event %lld.\n", ev);
+            return -1;
+        }
+    }
+    clusters.Finish();
+    hfile->Write();
+    ctx.StopTimer();
+    ctx.bytes = ctx.events * sizeof(float);
+    ctx.AddMetric("tot_bytes", tree->GetTotBytes());
+    ctx.AddMetric("zip_bytes", tree->GetZipBytes());
+    hfile->Close();
+    return ctx.events;
+}
+
+// Baskets per chunk handed to a ParallelTreeWriter worker.
+static const Long64_t kChunkBaskets = 16;
+
+/**
+ * As 'fill', with the entries split into chunks that ctx.threads workers
+ * fill and compress in memory while this thread appends them to the file
+ * in order.
+ */
+static Long64_t WriteParallel(BenchmarkContext &ctx) {
+    std::unique_ptr<TFile> hfile(CreateOutput(ctx));
+    if (!hfile) {return -1;}
+    Long64_t chunk_entries = std::max<Long64_t>(ctx.basket_size / sizeof(float), 1) * kChunkBaskets;
+    ParallelTreeWriter writer(hfile.get(), ctx.compression, ctx.threads, chunk_entries);
+    Int_t basket_size = ctx.basket_size;
+    auto filler = [basket_size](TTree *tree, Long64_t first, Long64_t count) {
+        float f = first + 2;
+        TBranch *branch = tree->Branch("myFloat", &f, basket_size, 1);
+        branch->SetAutoDelete(kFALSE);
+        for (Long64_t ev = 0; ev < count; ev++) {
+            if (R__unlikely(tree->Fill() < 0)) {return false;}
+            f++;
+        }
+        return true;
+    };
+    ctx.StartTimer();
+    TTree *tree = writer.Write("T", ctx.events, filler);
+    if (!tree) {
+        printf("Failed to write the tree with %d worker(s).\n", ctx.threads);
+        return -1;
+    }
+    hfile->Write();
+    ctx.StopTimer();
+    ctx.bytes = ctx.events * sizeof(float);
+    ctx.AddMetric("tot_bytes", tree->GetTotBytes());
+    ctx.AddMetric("zip_bytes", tree->GetZipBytes());
+    ctx.AddMetric("workers", ctx.threads);
+    ctx.AddMetric("chunks", writer.GetChunks());
+    ctx.AddMetric("compress_s", writer.GetCompressSeconds());
+    ctx.AddMetric("merge_s", writer.GetMergeSeconds());
+    ctx.AddMetric("merge_wait_s", writer.GetWaitSeconds());
+    hfile->Close();
+    return ctx.events;
+}
+
+const std::vector<BenchmarkMode> &GetWriteModes() {
+    static const std::vector<BenchmarkMode> modes = {
+        {"fill", "TTree::Fill once per event", WriteFill, false, true},
+        {"fillstats", "fill, plus per-basket min/max statistics for basket skipping", WriteFillStats, false, true},
+        {"parallelwrite", "fill in chunks compressed by --threads workers, appended in order", WriteParallel, true, true},
+        {"bulkwrite", "BulkColumnWriter<float>: whole arrays serialized straight into the baskets, clustered as by fill", WriteBulk, false, true},
+    };
+    return modes;
+}
+
+const BenchmarkMode *FindWriteMode(const std::string &name) {
+    for (const auto &mode : GetWriteModes()) {
+        if (name == mode.name) {return &mode;}
+    }
+    return nullptr;
+}
@@ -0,0 +1,22 @@
+#ifndef BULKAPI_WRITE_MODES_H
+#define BULKAPI_WRITE_MODES_H
+
+#include <string>
+#include <vector>
+
+#include "BenchmarkContext.h"
+
+/**
+ * The write modes of the float micro benchmark.
+ *
+ * Each mode (re)creates ctx.fname holding ctx.events entries of the 'myFloat'
+ * branch, in the layout floatMicroBenchmark writes, using the compression
+ * settings and basket size in the context.  The timed region includes the
+ * final TFile::Write so the last baskets are compressed and written too.
+ */
+const std::vector<BenchmarkMode> &GetWriteModes();
+
+/// Returns nullptr if there is no mode with the given name.
+const BenchmarkMode *FindWriteMode(const std::string &name);
+
+#endif  // BULKAPI_WRITE_MODES_H